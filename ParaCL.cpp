@@ -1,28 +1,530 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <cstdlib>
+#include <optional>
+#include <vector>
 #include <fstream>
+#include <iterator>
+#include <sstream>
+#include <iostream>
+#include <filesystem>
+
+#include <fcntl.h>
+#include <unistd.h>
+
 #include "include/frontend/Driver.hpp"
+#include "include/frontend/NodeSemanticAnalyzer.hpp"
+#include "include/frontend/NodeCodeGenerator.hpp"
+#include "include/backend/VM.hpp"
+#include "include/backend/Loader.hpp"
+#include "include/backend/CompileCache.hpp"
+#include "include/support/ThreadPool.hpp"
+#include "include/server/Server.hpp"
+
+#ifdef PARACL_LLVM
+#include "include/frontend/NodeIRGenerator.hpp"
+#include "include/backend/Native.hpp"
+#endif
 
 using namespace paracl::frontend;
+using namespace paracl::backend;
+
+namespace
+{
+
+enum class StatsFormat
+{
+    NONE,
+    TEXT,
+    JSON,
+};
+
+void report(const Statistics& stats, StatsFormat format) {
+    if (format == StatsFormat::JSON) {
+        stats.reportJson(std::cerr);
+    } else if (format == StatsFormat::TEXT) {
+        stats.report(std::cerr);
+    }
+}
+
+void reportPairs(const Executer& executer) {
+    std::cerr << "hottest instruction pairs:\n";
+    for (const auto& pair: executer.hottestPairs(16)) {
+        std::cerr << "  " << opcodeName(pair.first_) << " -> " << opcodeName(pair.second_)
+                  << "  " << pair.count_ << '\n';
+    }
+}
+
+void execute(const ProgramView& program, Statistics& stats, bool jit, bool profilePairs,
+             Buffering buffering) {
+    stats.collectProgram(program);
+    std::cout.flush();
+    Executer executer{STDIN_FILENO, STDOUT_FILENO, buffering};
+    executer.enableJit(jit);
+    // Counting runs the interpreter only, so with the JIT on the timed run
+    // would not be the real one.
+    bool count = stats.enabled() && !jit;
+    executer.countInstructions(count);
+    if (profilePairs) {
+        executer.setProfile(Profile::PAIRS);
+    }
+    {
+        auto timer = stats.time("execute");
+        executer.run(program);
+    }
+    if (count) {
+        stats.setExecuted(executer.executed());
+    }
+    if (profilePairs) {
+        reportPairs(executer);
+    }
+}
+
+struct NativeOptions
+{
+    bool run_ = false;
+    std::string objectPath_;
+    std::string irPath_;
+
+    bool requested() const {
+        return run_ || !objectPath_.empty() || !irPath_.empty();
+    }
+};
+
+#ifdef PARACL_LLVM
+
+int compileNative(Driver& drv, const std::string& name, const NativeOptions& native,
+                  bool optimize, Statistics& stats) {
+    auto context = std::make_unique<llvm::LLVMContext>();
+    std::unique_ptr<llvm::Module> module;
+    {
+        auto timer = stats.time("irgen");
+        NodeIRGenerator generator{*context, name, *drv.getInterner(), *drv.getLines()};
+        module = generator.generate(drv.getAST()->getRoot());
+    }
+    {
+        auto timer = stats.time("llvm-opt");
+        optimizeModule(*module, optimize);
+    }
+    if (!native.irPath_.empty()) {
+        std::error_code ec;
+        llvm::raw_fd_ostream out{native.irPath_, ec};
+        if (ec) {
+            throw std::runtime_error("can not open " + native.irPath_);
+        }
+        module->print(out, nullptr);
+    }
+    if (!native.objectPath_.empty()) {
+        auto timer = stats.time("emit-obj");
+        emitObject(*module, native.objectPath_);
+    }
+    if (!native.run_) {
+        return 0;
+    }
+    auto timer = stats.time("execute");
+    std::cout.flush();
+    return runNative(std::move(context), std::move(module));
+}
+
+#else
+
+int compileNative(Driver& , const std::string& , const NativeOptions& , bool , Statistics& ) {
+    throw std::runtime_error("paracl is built without the LLVM backend (PARACL_LLVM=OFF)");
+}
+
+#endif
+
+enum class BatchMode
+{
+    NONE,
+    CHECK,
+    COMPILE,
+};
+
+struct Unit
+{
+    std::string path_;
+    std::string diagnostics_;
+    bool ok_ = false;
+};
 
-int main() {
+// Every unit gets its own Driver, so units share nothing but the pool.
+void compileUnit(Unit& unit, BatchMode mode, bool optimize) {
+    std::ostringstream diagnostics;
     try {
-        Driver drv{"../tests/ex1.cl"};
+        Driver drv{unit.path_};
         drv.getParser()->parse();
-        if (drv.getAST()->getRoot() != nullptr) {
-            drv.getAST()->semanticAnalyze(drv);
-            std::fstream dumpFile{"../res/dump_ex1.dot", std::ios::out};
-            drv.getAST()->dump(dumpFile);
-
-            std::fstream dumpFile2{"../res/dump_ex2.dot", std::ios::out};
-            AST ast{*drv.getAST()};
-            ast.dump(dumpFile2);
+        AST* ast = drv.getAST();
+        if (ast->getRoot() != nullptr) {
+            ast->semanticAnalyze(drv);
         }
         if (drv.getReporter()->hasErrors()) {
-            drv.getReporter()->reportAllErrors(std::cout);
+            drv.getReporter()->reportAllErrors(diagnostics);
+        } else {
+            if (mode == BatchMode::COMPILE) {
+                if (optimize) {
+                    ast->optimize();
+                }
+                Program program;
+                ast->compile(program);
+                auto path = std::filesystem::path{unit.path_}.replace_extension(".pclb").string();
+                std::ofstream file{path, std::ios::binary};
+                writeByteCode(file, program);
+                if (!file) {
+                    throw std::runtime_error("can not write " + path);
+                }
+            }
+            unit.ok_ = true;
+        }
+    } catch (const std::exception& e) {
+        diagnostics << unit.path_ << ": " << e.what() << '\n';
+    }
+    unit.diagnostics_ = diagnostics.str();
+}
+
+// Sends the program and all of stdin to a `paracl --serve` server.
+int connect(const std::string& socketPath, const std::string& sourcePath) {
+    std::ifstream file{sourcePath, std::ios::binary};
+    if (!file) {
+        std::cerr << "can not open " << sourcePath << std::endl;
+        return 1;
+    }
+    std::string program{std::istreambuf_iterator<char>{file}, {}};
+    std::string input{std::istreambuf_iterator<char>{std::cin}, {}};
+    return paracl::server::request(socketPath, program, input, std::cout, std::cerr);
+}
+
+// Checks or compiles the inputs in parallel and reports their diagnostics
+// in input order once all of them are done.
+int compileBatch(const std::vector<std::string>& inputs, BatchMode mode, bool optimize, size_t jobs) {
+    std::vector<Unit> units(inputs.size());
+    {
+        paracl::support::ThreadPool pool{jobs};
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            units[i].path_ = inputs[i];
+            pool.submit([&unit = units[i], mode, optimize] {
+                compileUnit(unit, mode, optimize);
+            });
+        }
+        pool.wait();
+    }
+    int status = 0;
+    for (const auto& unit: units) {
+        std::cerr << unit.diagnostics_;
+        if (!unit.ok_) {
+            status = 1;
+        }
+    }
+    return status;
+}
+
+// Runs every top-level statement as soon as it has been parsed: it is
+// analyzed against the globals declared so far, compiled on its own and
+// executed on a frame that keeps the globals, and then its nodes are
+// freed. Memory stays bounded by the largest statement and the globals.
+int runStreaming(const std::string& sourcePath, bool optimize, bool jit, Buffering buffering) {
+    bool fromStdin = sourcePath == "-";
+    std::ifstream file;
+    if (!fromStdin) {
+        file.open(sourcePath, std::ios::binary);
+        if (!file) {
+            std::cerr << "can not open " << sourcePath << std::endl;
+            return 1;
+        }
+    } else {
+        // A buffered std::cin can tell how much program text is waiting.
+        std::ios::sync_with_stdio(false);
+    }
+    std::istream& in = fromStdin ? std::cin : file;
+
+    // `?` reads stdin unless the program itself comes from there; then it
+    // is rejected before it runs and the executer never reads.
+    int input = fromStdin ? ::open("/dev/null", O_RDONLY | O_CLOEXEC) : STDIN_FILENO;
+    Executer executer{input, STDOUT_FILENO, buffering};
+    executer.enableJit(jit);
+
+    AST globalStore;
+    BlockStatement* globals = globalStore.createNode<BlockStatement>(SourceRange{});
+    std::vector<int32_t> frame;
+    paracl::backend::Program program;
+    Driver* drv = nullptr;
+    std::unique_ptr<NodeSemanticAnalyzer> analyzer;
+
+    auto run = [&](Statement* statement) {
+        ErrorReporter& reporter = *drv->getReporter();
+        AST& ast = *drv->getAST();
+        // After the first error the rest is still analyzed, for
+        // diagnostics, but no longer run.
+        analyzer->analyze(statement);
+        if (fromStdin) {
+            for (INode* node: PostOrderTraversal{statement}) {
+                if (isa<InputExpression>(node)) {
+                    reporter.reportError<InputFromProgramStream>(node->loc_);
+                }
+            }
+        }
+        if (!reporter.hasErrors()) {
+            ast.setRoot(statement);
+            if (optimize) {
+                ast.optimize();
+            }
+            NodeCodeGenerator generator{program, drv->getLines()};
+            generator.generate(globals, static_cast<Statement*>(ast.getRoot()));
+            executer.run(program.view(), frame);
+            // Temporaries read as zero again once their slots turn into
+            // globals.
+            frame.resize(globals->table_.size());
+            if (!drv->getLexer()->pending()) {
+                executer.flush();
+            }
+        }
+        ast.clear();
+    };
+
+    Driver driver{fromStdin ? "<stdin>" : sourcePath, in, run};
+    drv = &driver;
+    analyzer = std::make_unique<NodeSemanticAnalyzer>(driver);
+    analyzer->beginGlobals(globals, globalStore);
+    driver.getParser()->parse();
+    executer.flush();
+    if (input != STDIN_FILENO) {
+        ::close(input);
+    }
+    if (driver.getReporter()->hasErrors()) {
+        driver.getReporter()->reportAllErrors(std::cerr);
+        return 1;
+    }
+    return 0;
+}
+
+void usage(const char* self) {
+    std::cerr << "usage: " << self << " [--dump <file.dot>] [--no-optimize] [--emit-bytecode <file.pclb>]"
+              << " [--stats[=json]] [--no-jit] [--profile-pairs] [--interactive]"
+              << " [--cache-dir <dir>] [--cache-size <MiB>]"
+              << " [--llvm] [--emit-obj <file.o>] [--emit-llvm <file.ll>] <program.cl | ->\n"
+              << "       " << self << " [--stats[=json]] [--no-jit] [--profile-pairs] [--interactive] <program.pclb>\n"
+              << "       " << self << " --stream [--no-optimize] [--no-jit] [--interactive] <program.cl | ->\n"
+              << "       " << self << " --check|--compile [--jobs <n>] [--no-optimize] <program.cl>...\n"
+              << "       " << self << " --serve <socket> [--jobs <n>] [--time-limit <ms>] [--memory-limit <MiB>]"
+              << " [--no-optimize] [--no-jit]\n"
+              << "       " << self << " --connect <socket> <program.cl>" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    BatchMode batch = BatchMode::NONE;
+    size_t jobs = std::thread::hardware_concurrency();
+    paracl::server::ServerOptions server;
+    std::string connectPath;
+    std::string dumpPath;
+    std::string bytecodePath;
+    bool optimize = true;
+    bool jit = true;
+    bool profilePairs = false;
+    bool stream = false;
+    // Line-buffered output when a person is watching it.
+    Buffering buffering = ::isatty(STDOUT_FILENO) ? Buffering::LINE : Buffering::FULL;
+    NativeOptions native;
+    StatsFormat statsFormat = StatsFormat::NONE;
+    const char* cacheEnv = std::getenv("PARACL_CACHE_DIR");
+    std::string cacheDir = cacheEnv ? cacheEnv : "";
+    uintmax_t cacheSize = uintmax_t{64} << 20;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--dump" && i + 1 < argc) {
+            dumpPath = argv[++i];
+        } else if (arg == "--emit-bytecode" && i + 1 < argc) {
+            bytecodePath = argv[++i];
+        } else if (arg == "--stats") {
+            statsFormat = StatsFormat::TEXT;
+        } else if (arg == "--stats=json") {
+            statsFormat = StatsFormat::JSON;
+        } else if (arg == "--llvm") {
+            native.run_ = true;
+        } else if (arg == "--emit-obj" && i + 1 < argc) {
+            native.objectPath_ = argv[++i];
+        } else if (arg == "--emit-llvm" && i + 1 < argc) {
+            native.irPath_ = argv[++i];
+        } else if (arg == "--no-jit") {
+            jit = false;
+        } else if (arg == "--profile-pairs") {
+            profilePairs = true;
+        } else if (arg == "--interactive") {
+            buffering = Buffering::LINE;
+        } else if (arg == "--cache-dir" && i + 1 < argc) {
+            cacheDir = argv[++i];
+        } else if (arg == "--cache-size" && i + 1 < argc) {
+            cacheSize = uintmax_t{std::stoul(argv[++i])} << 20;
+        } else if (arg == "--no-optimize") {
+            optimize = false;
+        } else if (arg == "--stream") {
+            stream = true;
+        } else if (arg == "--check") {
+            batch = BatchMode::CHECK;
+        } else if (arg == "--compile") {
+            batch = BatchMode::COMPILE;
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            jobs = std::stoul(argv[++i]);
+        } else if (arg == "--serve" && i + 1 < argc) {
+            server.socketPath_ = argv[++i];
+        } else if (arg == "--connect" && i + 1 < argc) {
+            connectPath = argv[++i];
+        } else if (arg == "--time-limit" && i + 1 < argc) {
+            server.limits_.time_ = std::chrono::milliseconds{std::stoul(argv[++i])};
+        } else if (arg == "--memory-limit" && i + 1 < argc) {
+            server.limits_.memory_ = std::stoul(argv[++i]) << 20;
+        } else if (arg == "-" || arg[0] != '-') {
+            inputs.push_back(arg);
         } else {
-            assert(drv.getAST()->getRoot());
-            std::cout << "Nice" << std::endl;
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (batch != BatchMode::NONE && !inputs.empty()) {
+        return compileBatch(inputs, batch, optimize, jobs);
+    }
+    if (!server.socketPath_.empty() && inputs.empty()) {
+        server.workers_ = jobs;
+        server.optimize_ = optimize;
+        server.jit_ = jit;
+        try {
+            paracl::server::Server{server}.run();
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << '\n';
+        }
+        return 1;
+    }
+    if (!connectPath.empty() && inputs.size() == 1) {
+        try {
+            return connect(connectPath, inputs.front());
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+    }
+    if (inputs.size() != 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (stream) {
+        try {
+            return runStreaming(inputs.front(), optimize, jit, buffering);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+    }
+    const std::string& sourcePath = inputs.front();
+    bool fromStdin = sourcePath == "-";
+    if (!fromStdin && !std::ifstream{sourcePath}) {
+        std::cerr << "can not open " << sourcePath << std::endl;
+        return 1;
+    }
+
+    try {
+        if (!fromStdin && isByteCodeFile(sourcePath)) {
+            Statistics stats;
+            if (statsFormat != StatsFormat::NONE) {
+                stats.enable();
+            }
+            std::unique_ptr<Loader> loader;
+            {
+                auto timer = stats.time("load");
+                loader = std::make_unique<Loader>(sourcePath);
+            }
+            execute(loader->program(), stats, jit, profilePairs, buffering);
+            report(stats, statsFormat);
+            return 0;
+        }
+
+        // `-` reads the whole program from stdin, so `?` sees end of input.
+        auto source = fromStdin ? std::make_unique<SourceBuffer>(std::cin)
+                                : std::make_unique<SourceBuffer>(sourcePath);
+
+        // Only plain runs go through the cache: the other outputs need
+        // the AST. The key is taken before the scanner writes into the
+        // source buffer.
+        std::optional<CompileCache> cache;
+        std::string cacheKey;
+        if (!cacheDir.empty() && dumpPath.empty() && bytecodePath.empty() && !native.requested()) {
+            Statistics stats;
+            if (statsFormat != StatsFormat::NONE) {
+                stats.enable();
+            }
+            std::unique_ptr<Loader> loader;
+            {
+                auto timer = stats.time("cache");
+                cache.emplace(cacheDir, cacheSize);
+                cacheKey = CompileCache::key(source->view(), optimize ? "optimize" : "no-optimize");
+                loader = cache->find(cacheKey);
+            }
+            if (loader) {
+                execute(loader->program(), stats, jit, profilePairs, buffering);
+                report(stats, statsFormat);
+                return 0;
+            }
+        }
+
+        auto drv = std::make_unique<Driver>(fromStdin ? "<stdin>" : sourcePath, std::move(source));
+        Statistics& stats = *drv->getStats();
+        if (statsFormat != StatsFormat::NONE) {
+            stats.enable();
+        }
+        {
+            auto timer = stats.time("parse");
+            drv->getParser()->parse();
+        }
+        AST* ast = drv->getAST();
+        if (ast->getRoot() != nullptr) {
+            {
+                auto timer = stats.time("sema");
+                ast->semanticAnalyze(*drv);
+            }
+            stats.collectTree(ast->getRoot());
+            if (!dumpPath.empty()) {
+                auto timer = stats.time("dump");
+                std::fstream dumpFile{dumpPath, std::ios::out};
+                ast->dump(dumpFile, *drv->getInterner());
+            }
+        }
+        if (drv->getReporter()->hasErrors()) {
+            drv->getReporter()->reportAllErrors(std::cerr);
+            report(stats, statsFormat);
+            return 1;
+        }
+
+        if (optimize) {
+            auto timer = stats.time("optimize");
+            stats.setRemoved(ast->optimize());
+        }
+        if (native.requested()) {
+            int status = compileNative(*drv, sourcePath, native, optimize, stats);
+            report(stats, statsFormat);
+            return status;
+        }
+        Program program;
+        {
+            auto timer = stats.time("compile");
+            ast->compile(program);
+        }
+        if (cache) {
+            auto timer = stats.time("cache");
+            cache->store(cacheKey, program);
+        }
+        if (!bytecodePath.empty()) {
+            stats.collectProgram(program.view());
+            std::ofstream bytecodeFile{bytecodePath, std::ios::binary};
+            writeByteCode(bytecodeFile, program);
+            report(stats, statsFormat);
+            return 0;
         }
+        execute(program.view(), stats, jit, profilePairs, buffering);
+        report(stats, statsFormat);
     } catch(const std::exception& e) {
         std::cerr << e.what() << '\n';
+        return 1;
     }
 }
@@ -0,0 +1,87 @@
+#include <chrono>
+#include <string>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+
+#include "backend/VM.hpp"
+
+using namespace paracl::backend;
+
+namespace
+{
+
+// i = 0; s = 0; while (i < n) { s = s + i % 7; i = i + 1; } print s;
+// as the code generator emits it: rotated, with fused compare-and-branch.
+Program hotLoop(int32_t iterations) {
+    enum : int32_t { I, S, T };
+    Program program;
+    program.frameSize_ = 3;
+    program.code_ = {
+        {Opcode::LOADI, I, 0, 0},
+        {Opcode::LOADI, S, 0, 0},
+        {Opcode::JGEI,  I, iterations, 7},
+        {Opcode::MODI,  T, I, 7},
+        {Opcode::ADD,   S, S, T},
+        {Opcode::ADDI,  I, I, 1},
+        {Opcode::JLTI,  I, iterations, 3},
+        {Opcode::OUT,   S, 0, 0},
+        {Opcode::HALT,  0, 0, 0},
+    };
+    return program;
+}
+
+double measure(const Program& program, Dispatch dispatch, bool jit, int repeats, std::string& output) {
+    double best = 0;
+    for (int i = 0; i < repeats; ++i) {
+        std::istringstream in;
+        std::ostringstream out;
+        Executer executer{in, out};
+        executer.enableJit(jit);
+        auto start = std::chrono::steady_clock::now();
+        executer.run(program, dispatch);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+        output = out.str();
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int32_t iterations = argc > 1 ? std::stoi(argv[1]) : 50'000'000;
+    int repeats = argc > 2 ? std::stoi(argv[2]) : 5;
+    Program program = hotLoop(iterations);
+    double executed = 4.0 * iterations;
+
+    std::string switchOut;
+    std::string threadedOut;
+    std::string jitOut;
+    double switchTime = measure(program, Dispatch::SWITCH, false, repeats, switchOut);
+    double threadedTime = measure(program, Dispatch::THREADED, false, repeats, threadedOut);
+    double jitTime = measure(program, Dispatch::THREADED, true, repeats, jitOut);
+    if (switchOut != threadedOut || switchOut != jitOut) {
+        std::cerr << "execution strategies disagree: " << switchOut << " vs " << threadedOut
+                  << " vs " << jitOut << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "iterations " << iterations << ", best of " << repeats << "\n";
+    std::cout << "switch   " << switchTime << " s, " << switchTime * 1e9 / executed << " ns/instr\n";
+#ifdef PARACL_THREADED_DISPATCH
+    std::cout << "threaded " << threadedTime << " s, " << threadedTime * 1e9 / executed << " ns/instr\n";
+    std::cout << "speedup  " << switchTime / threadedTime << "x" << std::endl;
+#else
+    std::cout << "threaded dispatch is not available with this compiler" << std::endl;
+#endif
+#ifdef PARACL_JIT
+    std::cout << "jit      " << jitTime << " s, " << jitTime * 1e9 / executed << " ns/instr\n";
+    std::cout << "speedup  " << threadedTime / jitTime << "x over threaded" << std::endl;
+#else
+    std::cout << "the loop JIT is not available on this platform" << std::endl;
+#endif
+}
@@ -0,0 +1,322 @@
+#include <chrono>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+
+#include "frontend/Driver.hpp"
+#include "frontend/Scanner.hpp"
+#include "backend/VM.hpp"
+
+using namespace paracl::frontend;
+using namespace paracl::backend;
+
+namespace
+{
+
+// Generated programs that stress one dimension of the pipeline each.
+struct Workload
+{
+    std::string name_;
+    std::string source_;
+};
+
+// n independent straight-line statements: the front end in bulk.
+Workload flatProgram(size_t size) {
+    std::ostringstream os;
+    os << "v0 = 1;\n";
+    for (size_t i = 1; i < size; ++i) {
+        os << "v" << i << " = v" << i - 1 << " + " << i % 97 << " * 3 - v" << i / 2 << " % 7;\n";
+    }
+    os << "print v" << size - 1 << ";\n";
+    return {"flat", os.str()};
+}
+
+// Blocks nested `size` levels deep, each one declaring and reading a variable.
+Workload nestedProgram(size_t size) {
+    std::ostringstream os;
+    os << "x = 0;\n";
+    for (size_t i = 0; i < size; ++i) {
+        os << "if (x >= 0) { y" << i << " = x + " << i << "; x = y" << i << " % 1000;\n";
+    }
+    os << "print x;\n";
+    for (size_t i = 0; i < size; ++i) {
+        os << "}\n";
+    }
+    return {"nested", os.str()};
+}
+
+// Long left-leaning operator chains: deep expression trees.
+Workload chainProgram(size_t size) {
+    static const char* ops[] = {" + ", " - ", " * ", " < ", " == ", " && ", " || ", " % "};
+    std::ostringstream os;
+    os << "a = 3; b = 5;\n";
+    for (size_t line = 0; line < 16; ++line) {
+        os << "c" << line << " = a";
+        for (size_t i = 0; i < size; ++i) {
+            os << ops[(i + line) % std::size(ops)] << (i % 2 ? "b" : "(a + 1)");
+        }
+        os << ";\nprint c" << line << ";\n";
+    }
+    return {"chain", os.str()};
+}
+
+// One left-leaning chain and one parenthesized right-leaning chain, each
+// `size` levels deep: too deep for passes that recurse on the native stack.
+Workload deepProgram(size_t size) {
+    std::string source = "x = 1;\nleft = x";
+    source.reserve(size * 10);
+    for (size_t i = 0; i < size; ++i) {
+        source += " + x";
+    }
+    source += ";\nright = ";
+    for (size_t i = 0; i < size; ++i) {
+        source += "(x - ";
+    }
+    source += "x";
+    source.append(size, ')');
+    source += ";\nprint left; print right;\n";
+    return {"deep", std::move(source)};
+}
+
+// A hot while loop: execution dominates, the front end is negligible.
+Workload loopProgram(size_t size) {
+    std::ostringstream os;
+    os << "i = 0; s = 0;\n"
+       << "while (i < " << size << ") {\n"
+       << "    if (i % 3 == 0) s = s + i % 7; else s = s - 1;\n"
+       << "    i = i + 1;\n"
+       << "}\n"
+       << "print s;\n";
+    return {"loop", os.str()};
+}
+
+struct Timing
+{
+    std::string phase_;
+    double min_ = 0;
+    double median_ = 0;
+    // Source bytes per second are printed for the phases that only scan.
+    bool perByte_ = false;
+};
+
+// `prepare` runs untimed before every repetition of `func`.
+Timing measure(const std::string& phase, int repeats,
+               const std::function<void()>& prepare, const std::function<void()>& func) {
+    std::vector<double> samples;
+    for (int i = 0; i < repeats; ++i) {
+        prepare();
+        auto start = std::chrono::steady_clock::now();
+        func();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        samples.push_back(elapsed.count());
+    }
+    std::sort(samples.begin(), samples.end());
+    return {phase, samples.front(), samples[samples.size() / 2]};
+}
+
+struct Result
+{
+    Workload workload_;
+    size_t tokens_ = 0;
+    size_t nodes_ = 0;
+    size_t instructions_ = 0;
+    std::vector<Timing> timings_;
+};
+
+Result run(const Workload& workload, int repeats) {
+    Result result;
+    result.workload_ = workload;
+    std::unique_ptr<Driver> drv;
+    auto fresh = [&] {
+        std::istringstream source{workload.source_};
+        drv = std::make_unique<Driver>(workload.name_, source);
+    };
+    auto parse = [&] {
+        drv->getParser()->parse();
+        if (drv->getReporter()->hasErrors()) {
+            drv->getReporter()->reportAllErrors(std::cerr);
+            throw std::runtime_error("workload " + workload.name_ + " does not compile");
+        }
+    };
+    auto analyzed = [&] {
+        fresh();
+        parse();
+        drv->getAST()->semanticAnalyze(*drv);
+    };
+
+    // `lex` is the scanner the build selected, Flex unless PARACL_HAND_LEXER;
+    // `scan` is always the hand-written one, so it is only measured when it
+    // has Flex to compare with.
+    result.timings_.push_back(measure("lex", repeats, fresh, [&] {
+        size_t tokens = 0;
+        while (drv->getLexer()->getNextToken().kind() != Parser::symbol_kind::S_YYEOF) {
+            ++tokens;
+        }
+        result.tokens_ = tokens;
+    }));
+    result.timings_.back().perByte_ = true;
+#ifndef PARACL_HAND_LEXER
+    result.timings_.push_back(measure("scan", repeats, fresh, [&] {
+        LineIndex lines;
+        Scanner scanner{*drv, lines, *drv->getSource()};
+        size_t tokens = 0;
+        while (scanner.getNextToken().kind() != Parser::symbol_kind::S_YYEOF) {
+            ++tokens;
+        }
+        if (tokens != result.tokens_) {
+            throw std::runtime_error("scanners disagree on workload " + workload.name_);
+        }
+    }));
+    result.timings_.back().perByte_ = true;
+#endif
+    // Bison pulls tokens on demand, so this phase includes lexing.
+    result.timings_.push_back(measure("parse", repeats, fresh, parse));
+    result.timings_.push_back(measure("sema", repeats, [&] { fresh(); parse(); }, [&] {
+        drv->getAST()->semanticAnalyze(*drv);
+    }));
+    analyzed();
+    AST& ast = *drv->getAST();
+    result.nodes_ = ast.size();
+
+    result.timings_.push_back(measure("copy", repeats, [] {}, [&] {
+        AST copy{ast};
+    }));
+    result.timings_.push_back(measure("flatten", repeats, [] {}, [&] {
+        FlatAST flat = ast.flatten();
+    }));
+    result.timings_.push_back(measure("dump", repeats, [] {}, [&] {
+        std::ostringstream os;
+        ast.dump(os, *drv->getInterner());
+    }));
+    result.timings_.push_back(measure("optimize", repeats, analyzed, [&] {
+        drv->getAST()->optimize();
+    }));
+    Program program;
+    result.timings_.push_back(measure("compile", repeats, [] {}, [&] {
+        drv->getAST()->compile(program);
+    }));
+    result.instructions_ = program.code_.size();
+    result.timings_.push_back(measure("execute", repeats, [] {}, [&] {
+        std::istringstream in;
+        std::ostringstream out;
+        Executer executer{in, out};
+        executer.run(program);
+    }));
+
+    return result;
+}
+
+#ifdef PARACL_HAND_LEXER
+constexpr const char* LEXER = "hand";
+#else
+constexpr const char* LEXER = "flex";
+#endif
+
+void printText(std::ostream& os, const std::vector<Result>& results, int repeats) {
+    os << std::fixed << std::setprecision(3);
+#ifdef PARACL_HAND_LEXER
+    os << "lex runs the hand-written scanner; build without PARACL_HAND_LEXER"
+       << " to compare it with Flex in a scan phase\n";
+#endif
+    for (const auto& result: results) {
+        os << result.workload_.name_ << ": " << result.workload_.source_.size() << " bytes, "
+           << result.tokens_ << " tokens, " << result.nodes_ << " nodes, "
+           << result.instructions_ << " instructions, best/median of " << repeats << "\n";
+        for (const auto& timing: result.timings_) {
+            os << "    " << std::left << std::setw(10) << timing.phase_ << std::right
+               << std::setw(12) << timing.min_ * 1e3 << " ms"
+               << std::setw(12) << timing.median_ * 1e3 << " ms";
+            if (timing.perByte_) {
+                os << std::setw(12) << result.workload_.source_.size() / timing.min_ / 1e6 << " MB/s";
+            }
+            os << "\n";
+        }
+    }
+}
+
+void printJson(std::ostream& os, const std::vector<Result>& results, int repeats) {
+    os << std::setprecision(9);
+    os << "{\"lexer\": \"" << LEXER << "\", \"repeats\": " << repeats << ", \"workloads\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        os << (i ? ", " : "") << "{\"name\": \"" << result.workload_.name_ << "\""
+           << ", \"bytes\": " << result.workload_.source_.size()
+           << ", \"tokens\": " << result.tokens_
+           << ", \"nodes\": " << result.nodes_
+           << ", \"instructions\": " << result.instructions_
+           << ", \"phases\": {";
+        for (size_t j = 0; j < result.timings_.size(); ++j) {
+            const Timing& timing = result.timings_[j];
+            os << (j ? ", " : "") << "\"" << timing.phase_ << "\": {\"min_s\": " << timing.min_
+               << ", \"median_s\": " << timing.median_ << "}";
+        }
+        os << "}}";
+    }
+    os << "]}" << std::endl;
+}
+
+void usage(const char* self) {
+    std::cerr << "usage: " << self << " [--workload flat|nested|chain|deep|loop|all] [--scale <k>]"
+              << " [--repeats <n>] [--json]" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string only = "all";
+    size_t scale = 1;
+    int repeats = 5;
+    bool json = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--workload" && i + 1 < argc) {
+            only = argv[++i];
+        } else if (arg == "--scale" && i + 1 < argc) {
+            scale = std::stoul(argv[++i]);
+        } else if (arg == "--repeats" && i + 1 < argc) {
+            repeats = std::stoi(argv[++i]);
+        } else if (arg == "--json") {
+            json = true;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (scale == 0 || repeats <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    std::vector<Workload> workloads = {
+        flatProgram(20'000 * scale),
+        nestedProgram(1'000 * scale),
+        chainProgram(2'000 * scale),
+        deepProgram(1'000'000 * scale),
+        loopProgram(2'000'000 * scale),
+    };
+
+    try {
+        std::vector<Result> results;
+        for (const auto& workload: workloads) {
+            if (only == "all" || only == workload.name_) {
+                results.push_back(run(workload, repeats));
+            }
+        }
+        if (results.empty()) {
+            usage(argv[0]);
+            return 1;
+        }
+        if (json) {
+            printJson(std::cout, results, repeats);
+        } else {
+            printText(std::cout, results, repeats);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+}
@@ -0,0 +1,221 @@
+#include <chrono>
+#include <string>
+#include <vector>
+#include <iomanip>
+#include <iostream>
+#include <typeinfo>
+
+#include "frontend/AST.hpp"
+#include "frontend/FlatAST.hpp"
+#include "frontend/NodeVisitor.hpp"
+
+using namespace paracl::frontend;
+
+namespace
+{
+
+class CountingVisitor final : public NodeVisitor
+{
+public:
+    using NodeVisitor::visit;
+
+    size_t count_ = 0;
+
+    // The typeid if-chain NodeVisitor::visit(INode*) used before kind tags.
+    void visitByTypeid(INode* node) {
+        if (typeid(*node) == typeid(UnaryExpression)) {
+            visit(static_cast<UnaryExpression*>(node));
+        } else if (typeid(*node) == typeid(BinaryExpression)) {
+            visit(static_cast<BinaryExpression*>(node));
+        } else if (typeid(*node) == typeid(TernaryExpression)) {
+            visit(static_cast<TernaryExpression*>(node));
+        } else if (typeid(*node) == typeid(ConstantExpression)) {
+            visit(static_cast<ConstantExpression*>(node));
+        } else if (typeid(*node) == typeid(VariableExpression)) {
+            visit(static_cast<VariableExpression*>(node));
+        } else if (typeid(*node) == typeid(InputExpression)) {
+            visit(static_cast<InputExpression*>(node));
+        } else if (typeid(*node) == typeid(BlockStatement)) {
+            visit(static_cast<BlockStatement*>(node));
+        } else if (typeid(*node) == typeid(ExpressionStatement)) {
+            visit(static_cast<ExpressionStatement*>(node));
+        } else if (typeid(*node) == typeid(IfStatement)) {
+            visit(static_cast<IfStatement*>(node));
+        } else if (typeid(*node) == typeid(IfElseStatement)) {
+            visit(static_cast<IfElseStatement*>(node));
+        } else if (typeid(*node) == typeid(WhileStatement)) {
+            visit(static_cast<WhileStatement*>(node));
+        } else if (typeid(*node) == typeid(OutputStatement)) {
+            visit(static_cast<OutputStatement*>(node));
+        } else if (typeid(*node) == typeid(BreakStatement)) {
+            visit(static_cast<BreakStatement*>(node));
+        } else if (typeid(*node) == typeid(ContinueStatement)) {
+            visit(static_cast<ContinueStatement*>(node));
+        } else {
+            throw std::runtime_error("Can not cast base class");
+        }
+    }
+
+protected:
+    void visit(UnaryExpression* ) override { ++count_; }
+
+    void visit(BinaryExpression* ) override { ++count_; }
+
+    void visit(TernaryExpression* ) override { ++count_; }
+
+    void visit(ConstantExpression* ) override { ++count_; }
+
+    void visit(VariableExpression* ) override { ++count_; }
+
+    void visit(InputExpression* ) override { ++count_; }
+
+    void visit(BlockStatement* ) override { ++count_; }
+
+    void visit(ExpressionStatement* ) override { ++count_; }
+
+    void visit(IfStatement* ) override { ++count_; }
+
+    void visit(IfElseStatement* ) override { ++count_; }
+
+    void visit(WhileStatement* ) override { ++count_; }
+
+    void visit(OutputStatement* ) override { ++count_; }
+
+    void visit(BreakStatement* ) override { ++count_; }
+
+    void visit(ContinueStatement* ) override { ++count_; }
+};
+
+class FlatCountingVisitor final : public FlatVisitor
+{
+public:
+    using FlatVisitor::FlatVisitor;
+
+    size_t count_ = 0;
+
+protected:
+    void visitUnary(NodeId ) override { ++count_; }
+
+    void visitBinary(NodeId ) override { ++count_; }
+
+    void visitTernary(NodeId ) override { ++count_; }
+
+    void visitConstant(NodeId ) override { ++count_; }
+
+    void visitVariable(NodeId ) override { ++count_; }
+
+    void visitInput(NodeId ) override { ++count_; }
+
+    void visitBlock(NodeId ) override { ++count_; }
+
+    void visitExpressionStatement(NodeId ) override { ++count_; }
+
+    void visitIf(NodeId ) override { ++count_; }
+
+    void visitIfElse(NodeId ) override { ++count_; }
+
+    void visitWhile(NodeId ) override { ++count_; }
+
+    void visitOutput(NodeId ) override { ++count_; }
+
+    void visitBreak(NodeId ) override { ++count_; }
+
+    void visitContinue(NodeId ) override { ++count_; }
+};
+
+// Mixes every node kind, statement kinds last in the typeid chain included:
+// while (x) { if (x) print -x; else { x = x ? 1 : 2; } break; continue; }
+Statement* makeStatement(AST& ast) {
+    SourceRange loc;
+    auto var = [&] { return ast.createNode<VariableExpression>(loc, SymbolId{0}); };
+    auto* cond = ast.createNode<BinaryExpression>(loc, BinaryOperation::BIN_L, var(), ast.createNode<InputExpression>(loc));
+    auto* print = ast.createNode<OutputStatement>(loc, ast.createNode<UnaryExpression>(loc, UnaryOperation::UN_SUB, var()));
+    auto* ternary = ast.createNode<TernaryExpression>(loc, var(),
+        ast.createNode<ConstantExpression>(loc, 1), ast.createNode<ConstantExpression>(loc, 2));
+    auto* assign = ast.createNode<ExpressionStatement>(loc,
+        ast.createNode<BinaryExpression>(loc, BinaryOperation::BIN_ASSIGN, var(), ternary));
+    auto* inner = ast.createNode<BlockStatement>(loc);
+    inner->statements_.push_back(assign);
+    auto* body = ast.createNode<BlockStatement>(loc);
+    body->statements_.push_back(ast.createNode<IfElseStatement>(loc, var(), print, inner));
+    body->statements_.push_back(ast.createNode<IfStatement>(loc, var(), ast.createNode<BreakStatement>(loc)));
+    body->statements_.push_back(ast.createNode<ContinueStatement>(loc));
+    return ast.createNode<WhileStatement>(loc, cond, body);
+}
+
+template<typename Func>
+double measure(int repeats, Func func) {
+    double best = 0;
+    for (int i = 0; i < repeats; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (i == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    size_t target = argc > 1 ? std::stoul(argv[1]) : 1'000'000;
+    int repeats = argc > 2 ? std::stoi(argv[2]) : 5;
+
+    AST ast;
+    auto* root = ast.createNode<BlockStatement>(SourceRange{});
+    while (ast.size() < target) {
+        root->statements_.push_back(makeStatement(ast));
+    }
+    ast.setRoot(root);
+
+    CountingVisitor visitor;
+    std::vector<INode*> nodes = visitor.postOrderTraversal(root);
+
+    double traversal = measure(repeats, [&] {
+        nodes.clear();
+        visitor.postOrderTraversal(root, nodes);
+    });
+    double byTypeid = measure(repeats, [&] {
+        for (auto node: nodes) {
+            visitor.visitByTypeid(node);
+        }
+    });
+    double byKind = measure(repeats, [&] {
+        for (auto node: nodes) {
+            visitor.visit(node);
+        }
+    });
+    // A whole pass: the pointer tree has to be walked, the flat one is
+    // already in post-order.
+    double treePass = measure(repeats, [&] {
+        for (INode* node: visitor.postOrder(root)) {
+            visitor.visit(node);
+        }
+    });
+    FlatAST flat;
+    double flatten = measure(repeats, [&] {
+        flat = ast.flatten();
+    });
+    FlatCountingVisitor flatVisitor{flat};
+    double flatPass = measure(repeats, [&] {
+        flatVisitor.visitAll();
+    });
+    if (visitor.count_ != nodes.size() * 3 * repeats || flatVisitor.count_ != nodes.size() * repeats) {
+        std::cerr << "visited " << visitor.count_ << " nodes, expected " << nodes.size() * 3 * repeats
+                  << " and " << flatVisitor.count_ << " flat nodes" << std::endl;
+        return 1;
+    }
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "nodes " << nodes.size() << ", best of " << repeats << "\n";
+    std::cout << "post-order traversal  " << traversal * 1e3 << " ms\n";
+    std::cout << "typeid dispatch       " << byTypeid * 1e3 << " ms, " << byTypeid * 1e9 / nodes.size() << " ns/node\n";
+    std::cout << "kind tag dispatch     " << byKind * 1e3 << " ms, " << byKind * 1e9 / nodes.size() << " ns/node\n";
+    std::cout << "speedup               " << byTypeid / byKind << "x\n";
+    std::cout << "pointer tree pass     " << treePass * 1e3 << " ms, " << ast.bytes() / nodes.size() << " bytes/node without block lists\n";
+    std::cout << "flatten               " << flatten * 1e3 << " ms\n";
+    std::cout << "flat pass             " << flatPass * 1e3 << " ms, " << flat.bytes() / nodes.size() << " bytes/node\n";
+    std::cout << "speedup               " << treePass / flatPass << "x" << std::endl;
+}
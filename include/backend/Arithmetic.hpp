@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <stdexcept>
+
+namespace paracl::backend
+{
+
+// ParaCL integers wrap around on overflow instead of being UB.
+inline int32_t wrap(int64_t value) {
+    return static_cast<int32_t>(static_cast<uint32_t>(value));
+}
+
+inline int32_t divide(int32_t lhs, int32_t rhs) {
+    if (rhs == 0) {
+        throw std::runtime_error("division by zero");
+    }
+    if (rhs == -1) {
+        return wrap(-static_cast<int64_t>(lhs));
+    }
+    return lhs / rhs;
+}
+
+inline int32_t modulo(int32_t lhs, int32_t rhs) {
+    if (rhs == 0) {
+        throw std::runtime_error("division by zero");
+    }
+    if (rhs == -1) {
+        return 0;
+    }
+    return lhs % rhs;
+}
+
+} // namespace paracl::backend
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace paracl::backend
+{
+
+// Register machine: every variable and every temporary lives in a slot of
+// one flat frame. Operands are slot indices unless stated otherwise.
+//
+// a_ - destination slot (or the only source for OUT/JZ/JNZ)
+// b_ - first source slot (or immediate for LOADI)
+// c_ - second source slot, immediate for the *I forms,
+//      or jump target of every branch
+//
+// J<cc> a, b, c and J<cc>I a, imm, c are fused compare-and-branch
+// superinstructions: jump to c if `a <cc> b`. DEC_JNZ a, c decrements a
+// and jumps to c unless it became zero.
+// The operand kinds of every opcode are listed next to its name.
+#define PARACL_OPCODES(OPCODE)           \
+    OPCODE(HALT,  NONE, NONE, NONE)      \
+                                         \
+    OPCODE(MOV,   SLOT, SLOT, NONE)      \
+    OPCODE(LOADI, SLOT, IMM,  NONE)      \
+                                         \
+    OPCODE(ADD,   SLOT, SLOT, SLOT)      \
+    OPCODE(SUB,   SLOT, SLOT, SLOT)      \
+    OPCODE(MUL,   SLOT, SLOT, SLOT)      \
+    OPCODE(DIV,   SLOT, SLOT, SLOT)      \
+    OPCODE(MOD,   SLOT, SLOT, SLOT)      \
+                                         \
+    OPCODE(LT,    SLOT, SLOT, SLOT)      \
+    OPCODE(GT,    SLOT, SLOT, SLOT)      \
+    OPCODE(LE,    SLOT, SLOT, SLOT)      \
+    OPCODE(GE,    SLOT, SLOT, SLOT)      \
+    OPCODE(EQ,    SLOT, SLOT, SLOT)      \
+    OPCODE(NE,    SLOT, SLOT, SLOT)      \
+                                         \
+    OPCODE(ADDI,  SLOT, SLOT, IMM)       \
+    OPCODE(SUBI,  SLOT, SLOT, IMM)       \
+    OPCODE(MULI,  SLOT, SLOT, IMM)       \
+    OPCODE(DIVI,  SLOT, SLOT, IMM)       \
+    OPCODE(MODI,  SLOT, SLOT, IMM)       \
+                                         \
+    OPCODE(LTI,   SLOT, SLOT, IMM)       \
+    OPCODE(GTI,   SLOT, SLOT, IMM)       \
+    OPCODE(LEI,   SLOT, SLOT, IMM)       \
+    OPCODE(GEI,   SLOT, SLOT, IMM)       \
+    OPCODE(EQI,   SLOT, SLOT, IMM)       \
+    OPCODE(NEI,   SLOT, SLOT, IMM)       \
+                                         \
+    OPCODE(NEG,   SLOT, SLOT, NONE)      \
+    OPCODE(NOT,   SLOT, SLOT, NONE)      \
+    OPCODE(BOOL,  SLOT, SLOT, NONE)      \
+    OPCODE(INC,   SLOT, NONE, NONE)      \
+    OPCODE(DEC,   SLOT, NONE, NONE)      \
+                                         \
+    OPCODE(JMP,   NONE, NONE, TARGET)    \
+    OPCODE(JZ,    SLOT, NONE, TARGET)    \
+    OPCODE(JNZ,   SLOT, NONE, TARGET)    \
+                                         \
+    OPCODE(JLT,   SLOT, SLOT, TARGET)    \
+    OPCODE(JGT,   SLOT, SLOT, TARGET)    \
+    OPCODE(JLE,   SLOT, SLOT, TARGET)    \
+    OPCODE(JGE,   SLOT, SLOT, TARGET)    \
+    OPCODE(JEQ,   SLOT, SLOT, TARGET)    \
+    OPCODE(JNE,   SLOT, SLOT, TARGET)    \
+                                         \
+    OPCODE(JLTI,  SLOT, IMM,  TARGET)    \
+    OPCODE(JGTI,  SLOT, IMM,  TARGET)    \
+    OPCODE(JLEI,  SLOT, IMM,  TARGET)    \
+    OPCODE(JGEI,  SLOT, IMM,  TARGET)    \
+    OPCODE(JEQI,  SLOT, IMM,  TARGET)    \
+    OPCODE(JNEI,  SLOT, IMM,  TARGET)    \
+                                         \
+    OPCODE(DEC_JNZ, SLOT, NONE, TARGET)  \
+                                         \
+    OPCODE(IN,    SLOT, NONE, NONE)      \
+    OPCODE(OUT,   SLOT, NONE, NONE)
+
+enum class Opcode : uint8_t
+{
+#define OPCODE(name, a, b, c) name,
+    PARACL_OPCODES(OPCODE)
+#undef OPCODE
+};
+
+constexpr size_t opcodeCount = 0
+#define OPCODE(name, a, b, c) + 1
+    PARACL_OPCODES(OPCODE)
+#undef OPCODE
+    ;
+
+// What an instruction field holds, used to verify untrusted code.
+enum class OperandKind : uint8_t
+{
+    NONE,
+    SLOT,
+    IMM,
+    TARGET,
+};
+
+struct OperandKinds
+{
+    OperandKind a_;
+    OperandKind b_;
+    OperandKind c_;
+};
+
+inline OperandKinds operandKinds(Opcode op) {
+    static const OperandKinds kinds[] = {
+#define OPCODE(name, a, b, c) {OperandKind::a, OperandKind::b, OperandKind::c},
+        PARACL_OPCODES(OPCODE)
+#undef OPCODE
+    };
+    return kinds[static_cast<uint8_t>(op)];
+}
+
+inline const char* opcodeName(Opcode op) {
+    static const char* names[] = {
+#define OPCODE(name, a, b, c) #name,
+        PARACL_OPCODES(OPCODE)
+#undef OPCODE
+    };
+    return names[static_cast<uint8_t>(op)];
+}
+
+struct Instruction
+{
+    Opcode op_ = Opcode::HALT;
+    int32_t a_ = 0;
+    int32_t b_ = 0;
+    int32_t c_ = 0;
+};
+
+static_assert(sizeof(Instruction) == 16, "Instruction must stay fixed-width");
+
+struct SourceLocation
+{
+    uint32_t line_ = 0;
+    uint32_t column_ = 0;
+};
+
+// Non-owning program: either a compiled Program or a mapped bytecode file.
+struct ProgramView
+{
+    const Instruction* code_ = nullptr;
+    size_t size_ = 0;
+    uint32_t frameSize_ = 0;
+    // One entry per instruction or nullptr when there is no debug info.
+    const SourceLocation* locations_ = nullptr;
+};
+
+struct Program
+{
+    std::vector<Instruction> code_;
+    uint32_t frameSize_ = 0;
+    std::vector<SourceLocation> locations_;
+
+    ProgramView view() const {
+        bool debug = !locations_.empty() && locations_.size() == code_.size();
+        return ProgramView{code_.data(), code_.size(), frameSize_, debug ? locations_.data() : nullptr};
+    }
+};
+
+} // namespace paracl::backend
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <cstdint>
+#include <filesystem>
+#include <string_view>
+
+#include "Loader.hpp"
+
+namespace paracl::backend
+{
+
+// Bytecode of previously compiled programs, one `<key>.pclb` file per
+// program in a directory. The key is the SHA-256 of the compiler binary's
+// identity, the compile options and the source text, so an entry is never
+// stale: a changed source or a rebuilt compiler simply misses. The cache
+// is best effort, a directory that can not be read or written only
+// disables it.
+class CompileCache final
+{
+private:
+    std::filesystem::path dir_;
+    uintmax_t capacity_;
+
+    std::filesystem::path entry(const std::string& key) const {
+        return dir_ / (key + ".pclb");
+    }
+
+    // Removes the least recently used entries until the cache fits, and
+    // temporary files left behind by stores that never finished.
+    void trim();
+
+public:
+    // capacity bounds the total size of the entries in bytes.
+    CompileCache(const std::filesystem::path& dir, uintmax_t capacity);
+
+    static std::string key(std::string_view source, std::string_view options);
+
+    // Null on a miss. An entry that fails verification counts as a miss
+    // and is removed.
+    std::unique_ptr<Loader> find(const std::string& key);
+
+    // Writes a temporary file and renames it over the entry, so readers
+    // see either the whole entry or none.
+    void store(const std::string& key, const Program& program);
+};
+
+} // namespace paracl::backend
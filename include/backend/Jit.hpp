@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+#include "ByteCode.hpp"
+
+#if defined(__x86_64__) && defined(__linux__) && !defined(PARACL_NO_JIT)
+#define PARACL_JIT 1
+#endif
+
+namespace paracl::backend
+{
+
+// Template JIT for hot loops. The interpreter reports every backward
+// branch; once a loop header gets hot, the code from the header to the
+// last back-edge into it is translated instruction by instruction into
+// x86-64. Native code works on the interpreter's frame and returns the pc
+// at which the interpreter has to continue: a jump out of the loop, IN or
+// OUT, or a division by 0 or -1 that needs the interpreter's semantics.
+// With an interrupt flag, every iteration also polls the flag and leaves
+// to the interpreter once it is set.
+class Jit final
+{
+public:
+    using Entry = uint32_t (*)(int32_t* regs);
+
+    static constexpr uint32_t threshold = 1000;
+
+private:
+    struct Region
+    {
+        void* memory_;
+        size_t size_;
+    };
+
+    ProgramView program_;
+    const std::atomic<bool>* interrupt_;
+    std::vector<uint32_t> hotness_;
+    std::vector<Entry> entries_;
+    std::vector<Region> regions_;
+
+    Entry compile(size_t header);
+
+public:
+    explicit Jit(const ProgramView& program, const std::atomic<bool>* interrupt = nullptr)
+    : program_(program), interrupt_(interrupt), hotness_(program.size_, 0), entries_(program.size_, nullptr) {}
+
+    Jit(const Jit&) = delete;
+    Jit& operator=(const Jit&) = delete;
+
+    ~Jit();
+
+    // Native entry of the loop at header, nullptr while it is still cold
+    // or when it can not be compiled.
+    Entry backEdge(size_t header) {
+        if (Entry entry = entries_[header]) {
+            return entry;
+        }
+        if (++hotness_[header] == threshold) {
+            entries_[header] = compile(header);
+        }
+        return entries_[header];
+    }
+
+    size_t compiled() const {
+        return regions_.size();
+    }
+};
+
+} // namespace paracl::backend
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <ostream>
+
+#include "ByteCode.hpp"
+
+namespace paracl::backend
+{
+
+// On-disk layout, every section is written in the host byte order:
+//
+//   FileHeader
+//   int32_t        constants[constants_]
+//   Instruction    code[instructions_]
+//   SourceLocation locations[locations_]   (0 or one per instruction)
+//
+// Every value ParaCL has fits into an instruction immediate, so the
+// compiler currently leaves the constant pool empty.
+struct FileHeader
+{
+    static constexpr char magic[4] = {'P', 'C', 'L', 'B'};
+    static constexpr uint16_t currentVersion = 3;
+    static constexpr uint32_t byteOrderMark = 0x01020304;
+
+    char magic_[4] = {magic[0], magic[1], magic[2], magic[3]};
+    uint16_t version_ = currentVersion;
+    uint16_t flags_ = 0;
+    uint32_t byteOrder_ = byteOrderMark;
+    uint32_t frameSize_ = 0;
+    uint32_t constants_ = 0;
+    uint32_t instructions_ = 0;
+    uint32_t locations_ = 0;
+    uint32_t reserved_ = 0;
+};
+
+static_assert(sizeof(FileHeader) == 32, "FileHeader must stay fixed-width");
+
+void writeByteCode(std::ostream& os, const Program& program);
+
+// Structural check of a bytecode image: sizes, opcodes, slot operands
+// inside the frame, jump targets inside the code and a terminating
+// HALT/JMP. A verified image can not make the Executer touch memory
+// outside of the frame and the code. Throws std::runtime_error.
+ProgramView verifyByteCode(const void* data, size_t size);
+
+bool isByteCodeFile(const std::string& path);
+
+// Maps a bytecode file read-only and executes it in place.
+class Loader final
+{
+private:
+    void* data_ = nullptr;
+    size_t size_ = 0;
+    ProgramView program_;
+
+public:
+    explicit Loader(const std::string& path);
+
+    Loader(const Loader&) = delete;
+    Loader& operator=(const Loader&) = delete;
+
+    ~Loader();
+
+    const ProgramView& program() const {
+        return program_;
+    }
+};
+
+} // namespace paracl::backend
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+
+namespace paracl::backend
+{
+
+// Runs mem2reg always and the full -O2 pipeline when `full` is set.
+void optimizeModule(llvm::Module& module, bool full);
+
+// Compiles the module in-process with ORC LLJIT and calls its main().
+int runNative(std::unique_ptr<llvm::LLVMContext> context, std::unique_ptr<llvm::Module> module);
+
+// Writes a relocatable object for the host; link it with `cc file.o`.
+void emitObject(llvm::Module& module, const std::string& path);
+
+} // namespace paracl::backend
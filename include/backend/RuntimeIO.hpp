@@ -0,0 +1,115 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <charconv>
+
+namespace paracl::backend
+{
+
+// Runtime I/O of `?` and `print`. Both sides keep a large buffer and go
+// to the file descriptor (or the stream, for in-memory runs) only when it
+// runs empty or full, and integers are parsed and formatted with
+// from_chars/to_chars.
+
+enum class Buffering
+{
+    FULL,
+    LINE,  // flush after every print, for terminals
+};
+
+class Input final
+{
+private:
+    int fd_ = -1;
+    std::istream* stream_ = nullptr;
+    std::vector<char> buffer_;
+    size_t begin_ = 0;
+    size_t end_ = 0;
+    bool eof_ = false;
+
+    // Keeps the unread bytes and appends more; false at end of input.
+    bool fill();
+
+    bool readSlow(int32_t& value);
+
+public:
+    static constexpr size_t capacity = 1 << 16;
+
+    explicit Input(int fd)
+    : fd_(fd), buffer_(capacity) {}
+
+    explicit Input(std::istream& in)
+    : stream_(std::addressof(in)), buffer_(capacity) {}
+
+    // Skips whitespace and reads one decimal integer with an optional
+    // sign, like `std::cin >> value`. False on a malformed or
+    // out-of-range number and at end of input.
+    bool read(int32_t& value) {
+        const char* data = buffer_.data();
+        size_t pos = begin_;
+        while (pos != end_ && (data[pos] == ' ' || data[pos] == '\n')) {
+            ++pos;
+        }
+        // A number that ends before the buffer does needs no refill.
+        if (end_ - pos >= 16 && data[pos] != '+') {
+            auto [ptr, ec] = std::from_chars(data + pos, data + end_, value);
+            if (ec == std::errc{} && ptr != data + end_) {
+                begin_ = ptr - data;
+                return true;
+            }
+        }
+        begin_ = pos;
+        return readSlow(value);
+    }
+};
+
+class Output final
+{
+private:
+    int fd_ = -1;
+    std::ostream* stream_ = nullptr;
+    Buffering buffering_;
+    std::vector<char> buffer_;
+    size_t size_ = 0;
+
+public:
+    static constexpr size_t capacity = 1 << 16;
+
+    Output(int fd, Buffering buffering)
+    : fd_(fd), buffering_(buffering), buffer_(capacity) {}
+
+    Output(std::ostream& out, Buffering buffering)
+    : stream_(std::addressof(out)), buffering_(buffering), buffer_(capacity) {}
+
+    Output(const Output&) = delete;
+    Output& operator=(const Output&) = delete;
+
+    // Flushes what is left; errors at this point are dropped.
+    ~Output();
+
+    // Writes the value and a newline.
+    void write(int32_t value) {
+        // "-2147483648\n" is the longest line.
+        if (capacity - size_ < 12) {
+            flush();
+        }
+        char* first = buffer_.data() + size_;
+        auto [ptr, ec] = std::to_chars(first, buffer_.data() + capacity, value);
+        (void)ec;
+        *ptr++ = '\n';
+        size_ = ptr - buffer_.data();
+        if (buffering_ == Buffering::LINE) {
+            flush();
+        }
+    }
+
+    // Throws std::runtime_error when the output can not be written.
+    void flush();
+};
+
+} // namespace paracl::backend
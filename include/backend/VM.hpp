@@ -1,177 +1,135 @@
-#include <iostream>
-#include <string>
-#include <unordered_map>
+#pragma once
+
 #include <vector>
-#include <stack>
+#include <iostream>
+#include <exception>
 
+#include "Jit.hpp"
+#include "ByteCode.hpp"
+#include "RuntimeIO.hpp"
 
-// ALLOC : ID VAL
-// JUMP : STR_NUM
-// PRINT : ID
-// LOAD : ID
-// ADD, SUB, MUL, DIV : ID_res, ID_op1, ID_op2
-// ASSIGN : ID, val/id
+#if defined(__GNUC__) && !defined(PARACL_NO_COMPUTED_GOTO)
+#define PARACL_THREADED_DISPATCH 1
+#endif
 
-namespace Virtual_Machine
+namespace paracl::backend
 {
-    enum class Command
-    {
-        ALLOC,
-        JUMP,
-        ASSIGN,
-        PRINT,
-        ADD,
-        SUB,
-        MUL,
-        DIV
-    };
-
-    class Operand
-    {   
-        public:
-        virtual int get_val(const std::unordered_map<std::string, int> &variables) const = 0;
-        virtual std::string get_name() const = 0;
-        virtual ~Operand() { };
-    };
-
-    class Const_operand : public Operand
-    {
-        int val;
-        public:
-        virtual int get_val(const std::unordered_map<std::string, int> &variables) const override { return val; };
-        ~Const_operand() { }
-    };
-
-    class Variable_operand : public Operand
-    {
-        std::string var;
-        public:
-        virtual int get_val(const std::unordered_map<std::string, int> &variables) const override
-        {   //add check for end of map
-            return variables.find(var)->second;
-        };
-        virtual std::string get_name() const override { return var; };
-
-        ~Variable_operand() { }
-    };
-
-    class Expression
-    {
-        public:
-        Command action;
-        std::vector<Operand> args;
-    };
-
-    class Stack_Frame final
-    {   
-        
-        std::unordered_map<std::string, int> variables;
-        
-        // int push_stack_frame();
-
-        void jump(const std::vector<Operand> &operand)
-        {
-            
-        }
-
-        void alloc(const std::vector<Operand> &operand)
-        {
-            std::string var = operand[0].get_name();    
-            int val = operand[1].get_val(variables);
-            variables[var] = val;
-        }
 
-        void print(const std::vector<Operand> &operand) const
-        {
-            int val = operand[0].get_val(variables);
-            std::cout << val << std::endl;
-        }
-        void add(const std::vector<Operand> &operand)
-        {
-            std::string var = operand[0].get_name();
-            int val1 = operand[1].get_val(variables);
-            int val2 = operand[2].get_val(variables);
-            variables[var] = val1 + val2;
-        }
-        void sub(const std::vector<Operand> &operand)
-        {
-            std::string var = operand[0].get_name();
-            int val1 = operand[1].get_val(variables);
-            int val2 = operand[2].get_val(variables);
-            variables[var] = val1 - val2;
-        }
-        void mul(const std::vector<Operand> &operand)
-        {
-            std::string var = operand[0].get_name();
-            int val1 = operand[1].get_val(variables);
-            int val2 = operand[2].get_val(variables);
-            variables[var] = val1 * val2;
-        }
-        void div(const std::vector<Operand> &operand)
-        {
-            std::string var = operand[0].get_name();
-            int val1 = operand[1].get_val(variables);
-            int val2 = operand[2].get_val(variables);
-            // if(val2 == 0)
-            // throw
-            variables[var] = val1 / val2;
-        }
-
-        void assign(const std::vector<Operand> &operand)
-        {
-            std::string var = operand[0].get_name();
-            int val = operand[1].get_val(variables);
-            variables[var] = val;
-        }
+enum class Dispatch
+{
+    SWITCH,
+    THREADED,
+};
 
-        public:
-        Stack_Frame() { };
-
-        void execute(Expression & expr)
-        {
-            switch(expr.action)
-            {
-                case Command::ASSIGN:
-                    assign(expr.args);
-                    break;
-                case Command::ALLOC:
-                    alloc(expr.args);
-                    break;
-                case Command::PRINT:
-                    print(expr.args);
-                    break;
-                case Command::ADD:
-                    add(expr.args);
-                    break;
-                case Command::SUB:
-                    sub(expr.args);
-                    break;
-                case Command::MUL:
-                    mul(expr.args);
-                    break;
-                case Command::DIV:
-                    div(expr.args);
-                    break;
-                case Command::JUMP:
-                    jump(expr.args);
-            }
-        }
-    };
+// What a run records about the instructions it retires.
+enum class Profile
+{
+    NONE,
+    COUNT,
+    PAIRS,
+};
 
-    class Loader
-    {
-        std::vector<Expression> instructions;
-        void load_instructions_from_stream(std::istream & is)
-        {
+struct PairCount
+{
+    Opcode first_;
+    Opcode second_;
+    uint64_t count_;
+};
 
+class Executer final
+{
+private:
+    Input in_;
+    Output out_;
+    Profile profile_ = Profile::NONE;
+    uint64_t executed_ = 0;
+    bool jitEnabled_ = true;
+    Jit* jit_ = nullptr;
+    const std::atomic<bool>* interrupt_ = nullptr;
+
+    // Dynamic opcode pair counts, pairs_[previous * opcodeCount + current].
+    std::vector<uint64_t> pairs_;
+    size_t previous_ = 0;
+
+    template<Profile P>
+    void retire(Opcode op) {
+        ++executed_;
+        if constexpr (P == Profile::PAIRS) {
+            size_t current = static_cast<size_t>(op);
+            ++pairs_[previous_ * opcodeCount + current];
+            previous_ = current;
         }
-    };
-
-    class Executer
-    {
-        int stack_pointer = 0;
-
-        
-    };
-
-}
\ No newline at end of file
+    }
+
+    template<Profile P>
+    void execute(const ProgramView& program, int32_t* regs, Dispatch dispatch);
+
+    template<Profile P>
+    void runSwitch(const ProgramView& program, int32_t* regs);
+
+    template<Profile P>
+    void runThreaded(const ProgramView& program, int32_t* regs);
+
+    // Prefixes a runtime error with the source location of instruction pc.
+    [[noreturn]] static void fail(const ProgramView& program, size_t pc, const std::exception& e);
+
+public:
+    // Streams suit in-memory runs; the program's real stdin and stdout go
+    // through the file descriptors instead.
+    Executer(std::istream& in = std::cin, std::ostream& out = std::cout)
+    : in_(in), out_(out, Buffering::FULL) {}
+
+    Executer(int in, int out, Buffering buffering)
+    : in_(in), out_(out, buffering) {}
+
+    // THREADED silently falls back to SWITCH on compilers without
+    // computed goto.
+    void run(const ProgramView& program, Dispatch dispatch = Dispatch::THREADED);
+
+    void run(const Program& program, Dispatch dispatch = Dispatch::THREADED) {
+        run(program.view(), dispatch);
+    }
+
+    // Runs on a frame owned by the caller, grown to the program's frame
+    // size, so that values survive from one run to the next. Unlike the
+    // other overloads it leaves the output in the buffer.
+    void run(const ProgramView& program, std::vector<int32_t>& frame, Dispatch dispatch = Dispatch::THREADED);
+
+    // Profiling runs use separate instantiations of the dispatch loops, so
+    // the default ones do not pay for it.
+    void setProfile(Profile profile) {
+        profile_ = profile;
+    }
+
+    void countInstructions(bool counting) {
+        profile_ = counting ? Profile::COUNT : Profile::NONE;
+    }
+
+    // Output is otherwise written when the buffer is full, at the end of
+    // a run and when the Executer is destroyed.
+    void flush() {
+        out_.flush();
+    }
+
+    uint64_t executed() const {
+        return executed_;
+    }
+
+    // The most frequent adjacent instruction pairs of the last PAIRS run,
+    // the candidates for new superinstructions.
+    std::vector<PairCount> hottestPairs(size_t limit) const;
+
+    // Once the flag is set, the run stops at the next backward branch
+    // with a "time limit exceeded" error. Another thread sets it.
+    void interruptOn(const std::atomic<bool>* flag) {
+        interrupt_ = flag;
+    }
+
+    // Compiles hot loops to native code where PARACL_JIT is available.
+    // Profiling runs always stay in the interpreter.
+    void enableJit(bool enabled) {
+        jitEnabled_ = enabled;
+    }
+};
+
+} // namespace paracl::backend
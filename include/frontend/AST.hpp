@@ -1,13 +1,17 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <fstream>
 #include <utility>
 #include <iostream>
 
+#include "Arena.hpp"
 #include "INode.hpp"
+#include "FlatAST.hpp"
+#include "backend/ByteCode.hpp"
 
 namespace paracl::frontend
 {
@@ -17,11 +21,16 @@ class Driver;
 class AST final
 {
 private:
-    std::vector<std::unique_ptr<INode>> nodes_;
+    Arena arena_;
+    size_t nodes_ = 0;
     INode* root_ = nullptr;
+    // Lines of the program the nodes' locations point into. Without them
+    // the bytecode has no debug table.
+    const LineIndex* lines_ = nullptr;
 
 public:
-    AST() = default;
+    explicit AST(const LineIndex* lines = nullptr)
+    : lines_(lines) {}
 
     AST(const AST& rhs);
 
@@ -34,18 +43,24 @@ public:
         return *this;
     }
 
-    AST(AST&&) = default;
+    AST(AST&& rhs) noexcept
+    : arena_(std::move(rhs.arena_)), nodes_(std::exchange(rhs.nodes_, 0)),
+      root_(std::exchange(rhs.root_, nullptr)), lines_(rhs.lines_) {}
 
-    AST& operator=(AST&&) = default;
+    AST& operator=(AST&& rhs) noexcept {
+        arena_ = std::move(rhs.arena_);
+        nodes_ = std::exchange(rhs.nodes_, 0);
+        root_ = std::exchange(rhs.root_, nullptr);
+        lines_ = rhs.lines_;
+        return *this;
+    }
 
     ~AST() = default;
 
     template<typename NodeType, typename... NodeArgs>
     NodeType* createNode(NodeArgs&&... args) {
-        auto uptr = std::make_unique<NodeType>(std::forward<NodeArgs>(args)...);
-        auto ptr = uptr.get();
-        nodes_.push_back(std::move(uptr));
-        return ptr;
+        ++nodes_;
+        return arena_.create<NodeType>(std::forward<NodeArgs>(args)...);
     }
 
     void setRoot(INode* root) {
@@ -56,14 +71,41 @@ public:
         return root_;
     }
 
+    size_t size() const {
+        return nodes_;
+    }
+
+    // Bytes of the nodes themselves; statement lists and symbol tables of
+    // blocks come on top.
+    size_t bytes() const {
+        return arena_.allocated();
+    }
+
     void clear() {
-        nodes_.clear();
+        arena_.clear();
+        nodes_ = 0;
         root_ = nullptr;
     }
 
-    void dump(std::ostream& os) const;
+    const LineIndex* getLines() const {
+        return lines_;
+    }
+
+    void dump(std::ostream& os, const Interner& names) const;
 
     void semanticAnalyze(Driver& driver);
+
+    // Folds constants and prunes dead code, returns the number of removed
+    // nodes. The root itself may be replaced, or removed when it has no
+    // effect.
+    size_t optimize();
+
+    // Throws std::runtime_error once the program's frame and code would
+    // take more than memoryLimit bytes.
+    void compile(backend::Program& program, size_t memoryLimit = SIZE_MAX) const;
+
+    // Index-based copy, see FlatAST.
+    FlatAST flatten() const;
 };
 
 } // namespace paracl::frontend {
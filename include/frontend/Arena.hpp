@@ -0,0 +1,118 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+
+namespace paracl::frontend
+{
+
+// Chunked bump allocator. Objects are never freed one by one: clear() and
+// the destructor drop whole chunks, and only objects that actually need a
+// destructor are remembered and destroyed.
+class Arena final
+{
+private:
+    static constexpr size_t minChunkSize = 64 * 1024;
+    static constexpr size_t maxChunkSize = 4 * 1024 * 1024;
+
+    struct Destructor
+    {
+        void* object_;
+        void (*destroy_)(void*);
+    };
+
+    std::vector<std::unique_ptr<std::byte[]>> chunks_;
+    std::vector<Destructor> destructors_;
+    std::byte* cur_ = nullptr;
+    std::byte* end_ = nullptr;
+    size_t nextChunkSize_ = minChunkSize;
+    size_t allocated_ = 0;
+
+    void grow(size_t size, size_t align) {
+        size_t chunkSize = std::max(nextChunkSize_, size + align);
+        chunks_.push_back(std::make_unique_for_overwrite<std::byte[]>(chunkSize));
+        cur_ = chunks_.back().get();
+        end_ = cur_ + chunkSize;
+        nextChunkSize_ = std::min(nextChunkSize_ * 2, maxChunkSize);
+    }
+
+public:
+    Arena() = default;
+
+    Arena(const Arena&) = delete;
+
+    Arena& operator=(const Arena&) = delete;
+
+    Arena(Arena&& rhs) noexcept
+    : chunks_(std::move(rhs.chunks_)), destructors_(std::move(rhs.destructors_)),
+      cur_(std::exchange(rhs.cur_, nullptr)), end_(std::exchange(rhs.end_, nullptr)),
+      nextChunkSize_(std::exchange(rhs.nextChunkSize_, minChunkSize)),
+      allocated_(std::exchange(rhs.allocated_, 0)) {}
+
+    Arena& operator=(Arena&& rhs) noexcept {
+        if (this != std::addressof(rhs)) {
+            clear();
+            chunks_ = std::move(rhs.chunks_);
+            destructors_ = std::move(rhs.destructors_);
+            cur_ = std::exchange(rhs.cur_, nullptr);
+            end_ = std::exchange(rhs.end_, nullptr);
+            nextChunkSize_ = std::exchange(rhs.nextChunkSize_, minChunkSize);
+            allocated_ = std::exchange(rhs.allocated_, 0);
+        }
+        return *this;
+    }
+
+    ~Arena() {
+        clear();
+    }
+
+    void* allocate(size_t size, size_t align) {
+        auto space = static_cast<size_t>(end_ - cur_);
+        void* ptr = cur_;
+        if (!cur_ || !std::align(align, size, ptr, space)) {
+            grow(size, align);
+            ptr = cur_;
+            space = static_cast<size_t>(end_ - cur_);
+            std::align(align, size, ptr, space);
+        }
+        cur_ = static_cast<std::byte*>(ptr) + size;
+        allocated_ += size;
+        return ptr;
+    }
+
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            destructors_.push_back(Destructor{object, [](void* ptr) {
+                static_cast<T*>(ptr)->~T();
+            }});
+        }
+        return object;
+    }
+
+    void clear() {
+        for (auto it = destructors_.rbegin(); it != destructors_.rend(); ++it) {
+            it->destroy_(it->object_);
+        }
+        destructors_.clear();
+        chunks_.clear();
+        cur_ = end_ = nullptr;
+        nextChunkSize_ = minChunkSize;
+        allocated_ = 0;
+    }
+
+    size_t allocated() const {
+        return allocated_;
+    }
+
+    size_t chunks() const {
+        return chunks_.size();
+    }
+};
+
+} // namespace paracl::frontend
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <atomic>
+#include <stdexcept>
+#include <functional>
+
 #include "parser.tab.hh"
 #include "Errors.hpp"
 #include "Lexer.hpp"
 #include "AST.hpp"
+#include "Interner.hpp"
+#include "Location.hpp"
+#include "SourceBuffer.hpp"
+#include "Statistics.hpp"
 
 namespace paracl::frontend
 {
@@ -15,28 +23,88 @@ class ErrorReposter;
 
 class Driver
 {
+public:
+    // Takes a top-level statement of a streamed program. Its nodes are
+    // only valid during the call.
+    using StatementHandler = std::function<void(Statement*)>;
+
 private:
     std::string filepath_ = "";
+    StatementHandler handler_;
 
+    std::unique_ptr<LineIndex> lines_ = nullptr;
     std::unique_ptr<AST> tree_ = nullptr;
+    std::unique_ptr<SourceBuffer> source_ = nullptr;
+    std::unique_ptr<Interner> interner_ = nullptr;
     std::unique_ptr<Lexer> lexer_ = nullptr;
     std::unique_ptr<Parser> parser_ = nullptr;
     std::unique_ptr<ErrorReporter> reporter_ = nullptr;
+    std::unique_ptr<Statistics> stats_ = nullptr;
+    const std::atomic<bool>* interrupt_ = nullptr;
+
+    void init(std::istream* stream = nullptr) {
+        lines_ = std::make_unique<LineIndex>(getFilepath());
+        tree_ = std::make_unique<AST>(lines_.get());
+        interner_ = std::make_unique<Interner>();
+        lexer_ = stream ? std::make_unique<Lexer>(*this, *lines_, *stream)
+                        : std::make_unique<Lexer>(*this, *lines_, *source_);
+        parser_ = std::make_unique<Parser>(*this);
+        reporter_ = std::make_unique<ErrorReporter>(*lines_);
+        stats_ = std::make_unique<Statistics>();
+    }
 
 public:
+    // Scans the file in place through a private mapping.
     Driver(const std::string& filepath)
     : filepath_(filepath) {
-        tree_ = std::make_unique<AST>();
-        lexer_ = std::make_unique<Lexer>(*this, getFilepath());
-        parser_ = std::make_unique<Parser>(*this);
-        reporter_ = std::make_unique<ErrorReporter>();
+        source_ = std::make_unique<SourceBuffer>(filepath);
+        init();
+    }
+
+    // Reads the program from a stream; name is used in diagnostics.
+    Driver(const std::string& name, std::istream& in)
+    : filepath_(name) {
+        source_ = std::make_unique<SourceBuffer>(in);
+        init();
+    }
+
+    // Takes a source that has already been loaded, e.g. to look it up in
+    // the compilation cache first.
+    Driver(const std::string& name, std::unique_ptr<SourceBuffer> source)
+    : filepath_(name), source_(std::move(source)) {
+        init();
+    }
+
+    // Parses the program while it is being read and hands every top-level
+    // statement to handler as soon as it is complete, instead of building
+    // a tree of the whole program.
+    Driver(const std::string& name, std::istream& in, StatementHandler handler)
+    : filepath_(name), handler_(std::move(handler)) {
+        init(std::addressof(in));
+    }
+
+    // Called by the parser for every top-level statement: appends it to the
+    // translation unit, or streams it and returns null.
+    BlockStatement* addStatement(BlockStatement* unit, Statement* statement, const SourceRange& loc) {
+        if (handler_) {
+            handler_(statement);
+            return nullptr;
+        }
+        if (!unit) {
+            unit = tree_->createNode<BlockStatement>(loc);
+        }
+        unit->statements_.push_back(statement);
+        return unit;
     }
 
     void setFile(const std::string& filepath) {
         filepath_ = filepath;
         lexer_.reset();
-        lexer_ = std::make_unique<Lexer>(*this, getFilepath());
+        source_ = std::make_unique<SourceBuffer>(filepath);
+        lines_->clear();
+        lexer_ = std::make_unique<Lexer>(*this, *lines_, *source_);
         tree_->clear();
+        interner_->clear();
         reporter_->clear();
     }
 
@@ -44,10 +112,22 @@ public:
         return std::addressof(filepath_);
     }
 
+    LineIndex* getLines() {
+        return lines_.get();
+    }
+
     AST* getAST() {
         return tree_.get();
     }
 
+    SourceBuffer* getSource() {
+        return source_.get();
+    }
+
+    Interner* getInterner() {
+        return interner_.get();
+    }
+
     Lexer* getLexer() {
         return lexer_.get();
     }
@@ -59,6 +139,22 @@ public:
     ErrorReporter* getReporter() {
         return reporter_.get();
     }
+
+    Statistics* getStats() {
+        return stats_.get();
+    }
+
+    // Parsing and semantic analysis stop with a "time limit exceeded"
+    // error once the flag is set. Another thread sets it.
+    void interruptOn(const std::atomic<bool>* flag) {
+        interrupt_ = flag;
+    }
+
+    void checkInterrupt() const {
+        if (interrupt_ && interrupt_->load(std::memory_order_relaxed)) {
+            throw std::runtime_error("time limit exceeded");
+        }
+    }
 };
 
 } // namespace paracl::frontend
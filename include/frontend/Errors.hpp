@@ -5,21 +5,22 @@
 #include <fstream>
 #include <iostream>
 
-#include "location.hpp"
+#include "Location.hpp"
 
 namespace paracl::frontend
 {
 
 struct Error
 {
-    location loc_;
+    SourceRange loc_;
     std::string msg_;
 
-    Error(const location& loc, const std::string& msg) :
+    Error(const SourceRange& loc, const std::string& msg) :
         loc_(loc), msg_(msg) {}
 
-    virtual void print(std::ostream& os) const {
-        os << loc_ << " error '" << msg_ << "'" << std::endl;
+    virtual void print(std::ostream& os, const LineIndex& lines) const {
+        lines.print(os, loc_);
+        os << " error '" << msg_ << "'" << std::endl;
     }
 
     virtual ~Error() = default;
@@ -30,11 +31,12 @@ struct Lexical : public Error
     using Error::loc_;
     using Error::msg_;
 
-    Lexical(const location& loc, const std::string& msg) :
+    Lexical(const SourceRange& loc, const std::string& msg) :
         Error(loc, msg) {}
 
-    void print(std::ostream& os) const override {
-        os << loc_ << " error: lexical '" << msg_ << "'" << std::endl;
+    void print(std::ostream& os, const LineIndex& lines) const override {
+        lines.print(os, loc_);
+        os << " error: lexical '" << msg_ << "'" << std::endl;
     }
 };
 
@@ -45,11 +47,12 @@ struct UnknownToken : public Lexical
 
     std::string token_;
 
-    UnknownToken(const location& loc, const std::string& token) :
+    UnknownToken(const SourceRange& loc, const std::string& token) :
         Lexical(loc, "unknown type name "), token_(token) {}
 
-    void print(std::ostream& os) const override {
-        os << loc_ << " error: " << msg_ << "'" << token_ << "'" << std::endl;
+    void print(std::ostream& os, const LineIndex& lines) const override {
+        lines.print(os, loc_);
+        os << " error: " << msg_ << "'" << token_ << "'" << std::endl;
     }
 };
 
@@ -58,11 +61,12 @@ struct UnterminatedComment : public Lexical
     using Lexical::loc_;
     using Lexical::msg_;
 
-    UnterminatedComment(const location& loc) :
+    UnterminatedComment(const SourceRange& loc) :
         Lexical(loc, "unterminated /* comment") {}
 
-    void print(std::ostream& os) const override {
-        os << loc_ << " error: " << msg_ << std::endl;
+    void print(std::ostream& os, const LineIndex& lines) const override {
+        lines.print(os, loc_);
+        os << " error: " << msg_ << std::endl;
     }
 };
 
@@ -71,11 +75,12 @@ struct Syntax : public Error
     using Error::loc_;
     using Error::msg_;
 
-    Syntax(const location& loc, const std::string& msg) :
+    Syntax(const SourceRange& loc, const std::string& msg) :
         Error(loc, msg) {}
 
-    void print(std::ostream& os) const override {
-        os << loc_ << " " << msg_ << std::endl;
+    void print(std::ostream& os, const LineIndex& lines) const override {
+        lines.print(os, loc_);
+        os << " " << msg_ << std::endl;
     }
 };
 
@@ -84,11 +89,12 @@ struct Semantic : public Error
     using Error::loc_;
     using Error::msg_;
 
-    Semantic(const location& loc, const std::string& msg)
+    Semantic(const SourceRange& loc, const std::string& msg)
     : Error(loc, msg) {}
 
-    void print(std::ostream& os) const override {
-        os << loc_ << " error: semantic '" << msg_ << "'" << std::endl;
+    void print(std::ostream& os, const LineIndex& lines) const override {
+        lines.print(os, loc_);
+        os << " error: semantic '" << msg_ << "'" << std::endl;
     }
 };
 
@@ -97,11 +103,12 @@ struct UnassignableExpression : public Semantic
     using Error::loc_;
     using Error::msg_;
 
-    UnassignableExpression(const location& loc)
+    UnassignableExpression(const SourceRange& loc)
     : Semantic(loc, "expression is not assignable") {}
 
-    void print(std::ostream& os) const override {
-        os << loc_ << " error: " << msg_ << std::endl;
+    void print(std::ostream& os, const LineIndex& lines) const override {
+        lines.print(os, loc_);
+        os << " error: " << msg_ << std::endl;
     }
 };
 
@@ -112,11 +119,12 @@ struct UndeclaredIdentifier : public Semantic
 
     std::string ident_;
 
-    UndeclaredIdentifier(const location& loc, const std::string& ident)
+    UndeclaredIdentifier(const SourceRange& loc, const std::string& ident)
     : Semantic(loc, "use of undeclared identifier"), ident_(ident) {}
 
-    void print(std::ostream& os) const override {
-        os << loc_ << " error: " << msg_ << " '" << ident_ << "'" << std::endl;
+    void print(std::ostream& os, const LineIndex& lines) const override {
+        lines.print(os, loc_);
+        os << " error: " << msg_ << " '" << ident_ << "'" << std::endl;
     }
 };
 
@@ -127,21 +135,39 @@ struct OutOfLoopStatement : public Semantic
 
     std::string stat_;
 
-    OutOfLoopStatement(const location& loc, const std::string& stat)
+    OutOfLoopStatement(const SourceRange& loc, const std::string& stat)
     : Semantic(loc, "statement not in loop or switch statement"), stat_(stat) {}
 
-    void print(std::ostream& os) const override {
-        os << loc_ << " error: '" << stat_ << "' " << msg_ << std::endl;
+    void print(std::ostream& os, const LineIndex& lines) const override {
+        lines.print(os, loc_);
+        os << " error: '" << stat_ << "' " << msg_ << std::endl;
+    }
+};
+
+// `?` in a program streamed from stdin, which leaves it nothing to read.
+struct InputFromProgramStream : public Semantic
+{
+    using Error::loc_;
+    using Error::msg_;
+
+    InputFromProgramStream(const SourceRange& loc)
+    : Semantic(loc, "'?' can not read input: the program itself is read from stdin") {}
+
+    void print(std::ostream& os, const LineIndex& lines) const override {
+        lines.print(os, loc_);
+        os << " error: " << msg_ << std::endl;
     }
 };
 
 class ErrorReporter
 {
 private:
+    const LineIndex& lines_;
     std::vector<std::unique_ptr<Error>> errors_;
 
 public:
-    ErrorReporter() {}
+    explicit ErrorReporter(const LineIndex& lines)
+    : lines_(lines) {}
 
     template<typename ErrorType, typename... ErrorArgs>
     void reportError(ErrorArgs&&... args) {
@@ -159,7 +185,7 @@ public:
 
     void reportAllErrors(std::ostream& os) const {
         for (const auto& error: errors_) {
-            error->print(os);
+            error->print(os, lines_);
         }
     }
 
@@ -0,0 +1,260 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <stdexcept>
+
+#include "INode.hpp"
+
+namespace paracl::frontend
+{
+
+using NodeId = uint32_t;
+
+inline constexpr NodeId noNode = UINT32_MAX;
+
+// The AST flattened into per-field arrays indexed by NodeId. Nodes are
+// stored in post-order, children before their parent and the root last,
+// so a pass that only needs its children's results is a linear scan.
+// Every node has a kind, an operation and three 32-bit operands:
+//
+//   UNARY_EXPRESSION      op, expr
+//   BINARY_EXPRESSION     op, left, right
+//   TERNARY_EXPRESSION    condition, onTrue, onFalse
+//   CONSTANT_EXPRESSION   value
+//   VARIABLE_EXPRESSION   name, depth, slot
+//   INPUT_EXPRESSION      -
+//   BLOCK_STATEMENT       first statement in children_, count, declared variables
+//   EXPRESSION_STATEMENT  expr
+//   IF_STATEMENT          condition, trueBlock
+//   IF_ELSE_STATEMENT     condition, trueBlock, falseBlock
+//   WHILE_STATEMENT       condition, block
+//   OUTPUT_STATEMENT      expr
+//   BREAK_STATEMENT       enclosing while or noNode
+//   CONTINUE_STATEMENT    enclosing while or noNode
+//
+// Locations are only read for diagnostics and live in an array of their
+// own, out of the way of the hot ones.
+class FlatAST final
+{
+private:
+    std::vector<NodeKind> kinds_;
+    std::vector<uint8_t> ops_;
+    std::vector<uint32_t> operands_[3];
+    std::vector<SourceRange> locations_;
+    // Statements of all blocks, each block's a contiguous range.
+    std::vector<NodeId> children_;
+
+public:
+    FlatAST() = default;
+
+    void reserve(size_t nodes) {
+        kinds_.reserve(nodes);
+        ops_.reserve(nodes);
+        for (auto& operands: operands_) {
+            operands.reserve(nodes);
+        }
+        locations_.reserve(nodes);
+    }
+
+    NodeId add(NodeKind kind, const SourceRange& loc, uint8_t op = 0,
+               uint32_t first = noNode, uint32_t second = noNode, uint32_t third = noNode) {
+        if (kinds_.size() >= noNode) {
+            throw std::runtime_error("too many nodes for a flat AST");
+        }
+        kinds_.push_back(kind);
+        ops_.push_back(op);
+        operands_[0].push_back(first);
+        operands_[1].push_back(second);
+        operands_[2].push_back(third);
+        locations_.push_back(loc);
+        return static_cast<NodeId>(kinds_.size() - 1);
+    }
+
+    // Appends a block's statements, returns the index of the first one.
+    uint32_t addChildren(std::span<const NodeId> statements) {
+        auto first = static_cast<uint32_t>(children_.size());
+        children_.insert(children_.end(), statements.begin(), statements.end());
+        return first;
+    }
+
+    size_t size() const {
+        return kinds_.size();
+    }
+
+    bool empty() const {
+        return kinds_.empty();
+    }
+
+    NodeId root() const {
+        return kinds_.empty() ? noNode : static_cast<NodeId>(kinds_.size() - 1);
+    }
+
+    NodeKind kind(NodeId node) const {
+        return kinds_[node];
+    }
+
+    SourceRange loc(NodeId node) const {
+        return locations_[node];
+    }
+
+    // Raw operand, see the table above.
+    uint32_t operand(NodeId node, size_t index) const {
+        return operands_[index][node];
+    }
+
+    void setOperand(NodeId node, size_t index, uint32_t value) {
+        operands_[index][node] = value;
+    }
+
+    UnaryOperation unaryOp(NodeId node) const {
+        return static_cast<UnaryOperation>(ops_[node]);
+    }
+
+    BinaryOperation binaryOp(NodeId node) const {
+        return static_cast<BinaryOperation>(ops_[node]);
+    }
+
+    int value(NodeId node) const {
+        return static_cast<int>(operands_[0][node]);
+    }
+
+    SymbolId name(NodeId node) const {
+        return operands_[0][node];
+    }
+
+    int depth(NodeId node) const {
+        return static_cast<int>(operands_[1][node]);
+    }
+
+    int slot(NodeId node) const {
+        return static_cast<int>(operands_[2][node]);
+    }
+
+    std::span<const NodeId> statements(NodeId block) const {
+        return std::span<const NodeId>{children_}.subspan(operands_[0][block], operands_[1][block]);
+    }
+
+    size_t declared(NodeId block) const {
+        return operands_[2][block];
+    }
+
+    // Bytes held by the arrays, capacity included.
+    size_t bytes() const {
+        size_t total = kinds_.capacity() * sizeof(NodeKind) + ops_.capacity() * sizeof(uint8_t) +
+                       locations_.capacity() * sizeof(SourceRange) + children_.capacity() * sizeof(NodeId);
+        for (const auto& operands: operands_) {
+            total += operands.capacity() * sizeof(uint32_t);
+        }
+        return total;
+    }
+
+    void clear() {
+        kinds_.clear();
+        ops_.clear();
+        for (auto& operands: operands_) {
+            operands.clear();
+        }
+        locations_.clear();
+        children_.clear();
+    }
+};
+
+// NodeVisitor's counterpart over a FlatAST: a switch on the kind array
+// and one virtual call per node, no pointer chasing.
+class FlatVisitor
+{
+protected:
+    const FlatAST& ast_;
+
+public:
+    explicit FlatVisitor(const FlatAST& ast)
+    : ast_(ast) {}
+
+    void visit(NodeId node) {
+        switch (ast_.kind(node)) {
+        case NodeKind::UNARY_EXPRESSION:
+            visitUnary(node);
+            return;
+        case NodeKind::BINARY_EXPRESSION:
+            visitBinary(node);
+            return;
+        case NodeKind::TERNARY_EXPRESSION:
+            visitTernary(node);
+            return;
+        case NodeKind::CONSTANT_EXPRESSION:
+            visitConstant(node);
+            return;
+        case NodeKind::VARIABLE_EXPRESSION:
+            visitVariable(node);
+            return;
+        case NodeKind::INPUT_EXPRESSION:
+            visitInput(node);
+            return;
+        case NodeKind::BLOCK_STATEMENT:
+            visitBlock(node);
+            return;
+        case NodeKind::EXPRESSION_STATEMENT:
+            visitExpressionStatement(node);
+            return;
+        case NodeKind::IF_STATEMENT:
+            visitIf(node);
+            return;
+        case NodeKind::IF_ELSE_STATEMENT:
+            visitIfElse(node);
+            return;
+        case NodeKind::WHILE_STATEMENT:
+            visitWhile(node);
+            return;
+        case NodeKind::OUTPUT_STATEMENT:
+            visitOutput(node);
+            return;
+        case NodeKind::BREAK_STATEMENT:
+            visitBreak(node);
+            return;
+        case NodeKind::CONTINUE_STATEMENT:
+            visitContinue(node);
+            return;
+        }
+        throw std::runtime_error("Can not cast base class");
+    }
+
+    // Visits every node in post-order, which is storage order.
+    void visitAll() {
+        for (NodeId node = 0; node < ast_.size(); ++node) {
+            visit(node);
+        }
+    }
+
+protected:
+    virtual void visitUnary(NodeId node) = 0;
+
+    virtual void visitBinary(NodeId node) = 0;
+
+    virtual void visitTernary(NodeId node) = 0;
+
+    virtual void visitConstant(NodeId node) = 0;
+
+    virtual void visitVariable(NodeId node) = 0;
+
+    virtual void visitInput(NodeId node) = 0;
+
+    virtual void visitBlock(NodeId node) = 0;
+
+    virtual void visitExpressionStatement(NodeId node) = 0;
+
+    virtual void visitIf(NodeId node) = 0;
+
+    virtual void visitIfElse(NodeId node) = 0;
+
+    virtual void visitWhile(NodeId node) = 0;
+
+    virtual void visitOutput(NodeId node) = 0;
+
+    virtual void visitBreak(NodeId node) = 0;
+
+    virtual void visitContinue(NodeId node) = 0;
+};
+
+} // namespace paracl::frontend
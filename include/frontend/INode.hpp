@@ -4,11 +4,12 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <cstdint>
 #include <fstream>
 #include <utility>
 #include <iostream>
 
-#include "location.hpp"
+#include "Location.hpp"
 #include "SymTable.hpp"
 
 namespace paracl::frontend
@@ -17,24 +18,47 @@ namespace paracl::frontend
 class NodeVisitor;
 class SymTable;
 
+enum class NodeKind : uint8_t
+{
+    UNARY_EXPRESSION,
+    BINARY_EXPRESSION,
+    TERNARY_EXPRESSION,
+    CONSTANT_EXPRESSION,
+    VARIABLE_EXPRESSION,
+    INPUT_EXPRESSION,
+
+    BLOCK_STATEMENT,
+    EXPRESSION_STATEMENT,
+    IF_STATEMENT,
+    IF_ELSE_STATEMENT,
+    WHILE_STATEMENT,
+    OUTPUT_STATEMENT,
+    BREAK_STATEMENT,
+    CONTINUE_STATEMENT,
+};
+
 struct INode
 {
-    location loc_;
+    NodeKind kind_;
+    SourceRange loc_;
 
-    INode(const location &loc) :
-        loc_(loc) {}
+    INode(NodeKind kind, const SourceRange&loc) :
+        kind_(kind), loc_(loc) {}
 
     virtual void accept(NodeVisitor& visitor);
 
-    virtual ~INode() {}
+protected:
+    // Nodes live in the AST arena and are destroyed through their concrete
+    // type, so most of them stay trivially destructible.
+    ~INode() = default;
 };
 
 struct Expression : public INode
 {
     using INode::loc_;
 
-    Expression(const location& loc) :
-        INode(loc) {}
+    Expression(NodeKind kind, const SourceRange& loc) :
+        INode(kind, loc) {}
 };
 
 enum class UnaryOperation
@@ -51,13 +75,15 @@ enum class UnaryOperation
 
 struct UnaryExpression : public Expression
 {
+    static constexpr NodeKind kind = NodeKind::UNARY_EXPRESSION;
+
     using Expression::loc_;
 
     UnaryOperation op_;
     Expression* expr_ = nullptr;
 
-    UnaryExpression(const location& loc, UnaryOperation op, Expression* expr) :
-        Expression(loc), op_(op), expr_(expr) {}
+    UnaryExpression(const SourceRange& loc, UnaryOperation op, Expression* expr) :
+        Expression(kind, loc), op_(op), expr_(expr) {}
 };
 
 enum class BinaryOperation
@@ -85,147 +111,186 @@ enum class BinaryOperation
 
 struct BinaryExpression : public Expression
 {
+    static constexpr NodeKind kind = NodeKind::BINARY_EXPRESSION;
+
     using Expression::loc_;
 
     BinaryOperation op_;
     Expression* left_ = nullptr;
     Expression* right_ = nullptr;
 
-    BinaryExpression(const location& loc, BinaryOperation op, Expression* left, Expression* right) :
-        Expression(loc), op_(op), left_(left), right_(right) {}
+    BinaryExpression(const SourceRange& loc, BinaryOperation op, Expression* left, Expression* right) :
+        Expression(kind, loc), op_(op), left_(left), right_(right) {}
 };
 
 struct TernaryExpression : public Expression
 {
+    static constexpr NodeKind kind = NodeKind::TERNARY_EXPRESSION;
+
     using Expression::loc_;
 
     Expression* condition_ = nullptr;
     Expression* onTrue_ = nullptr;
     Expression* onFalse_ = nullptr;
 
-    TernaryExpression(const location& loc, Expression* condition, Expression* onTrue, Expression* onFalse) :
-        Expression(loc), condition_(condition), onTrue_(onTrue), onFalse_(onFalse) {}
+    TernaryExpression(const SourceRange& loc, Expression* condition, Expression* onTrue, Expression* onFalse) :
+        Expression(kind, loc), condition_(condition), onTrue_(onTrue), onFalse_(onFalse) {}
 };
 
 struct ConstantExpression : public Expression
 {
+    static constexpr NodeKind kind = NodeKind::CONSTANT_EXPRESSION;
+
     using Expression::loc_;
 
     int value_;
 
-    ConstantExpression(const location& loc, const int& value) :
-        Expression(loc), value_(value) {}
+    ConstantExpression(const SourceRange& loc, const int& value) :
+        Expression(kind, loc), value_(value) {}
 };
 
 struct VariableExpression : public Expression
 {
+    static constexpr NodeKind kind = NodeKind::VARIABLE_EXPRESSION;
+
     using Expression::loc_;
 
-    std::string name_;
+    SymbolId name_;
+    // Resolved by NodeSemanticAnalyzer: nesting depth of the declaring
+    // BlockStatement and the variable's slot in that block's frame.
+    int depth_ = -1;
+    int slot_ = -1;
 
-    VariableExpression(const location& loc, const std::string& name) :
-        Expression(loc), name_(name) {}
+    VariableExpression(const SourceRange& loc, SymbolId name) :
+        Expression(kind, loc), name_(name) {}
 };
 
 struct InputExpression : public Expression
 {
+    static constexpr NodeKind kind = NodeKind::INPUT_EXPRESSION;
+
     using Expression::loc_;
 
-    InputExpression(const location& loc):
-        Expression(loc) {}
+    InputExpression(const SourceRange& loc):
+        Expression(kind, loc) {}
 };
 
 struct Statement : public INode
 {
     using INode::loc_;
 
-    Statement(const location &loc) :
-        INode(loc) {}
+    Statement(NodeKind kind, const SourceRange&loc) :
+        INode(kind, loc) {}
 };
 
 struct BlockStatement : public Statement
 {
+    static constexpr NodeKind kind = NodeKind::BLOCK_STATEMENT;
+
     using Statement::loc_;
 
     SymTable table_;
     std::deque<Statement* > statements_;
 
-    BlockStatement(const location& loc) :
-        Statement(loc) {}
+    BlockStatement(const SourceRange& loc) :
+        Statement(kind, loc) {}
 };
 
 struct ExpressionStatement : public Statement
 {
+    static constexpr NodeKind kind = NodeKind::EXPRESSION_STATEMENT;
+
     using Statement::loc_;
 
     Expression* expr_;
 
-    ExpressionStatement(const location& loc, Expression* expr) :
-        Statement(loc), expr_(expr) {}
+    ExpressionStatement(const SourceRange& loc, Expression* expr) :
+        Statement(kind, loc), expr_(expr) {}
 };
 
 struct IfStatement : public Statement
 {
+    static constexpr NodeKind kind = NodeKind::IF_STATEMENT;
+
     using Statement::loc_;
 
     Expression* condition_ = nullptr;
     Statement* trueBlock_ = nullptr;
 
-    IfStatement(const location& loc, Expression* condition, Statement* trueBlock) :
-        Statement(loc), condition_(condition), trueBlock_(trueBlock) {}
+    IfStatement(const SourceRange& loc, Expression* condition, Statement* trueBlock) :
+        Statement(kind, loc), condition_(condition), trueBlock_(trueBlock) {}
+
+protected:
+    IfStatement(NodeKind kind, const SourceRange& loc, Expression* condition, Statement* trueBlock) :
+        Statement(kind, loc), condition_(condition), trueBlock_(trueBlock) {}
 };
 
 struct IfElseStatement : public IfStatement
 {
+    static constexpr NodeKind kind = NodeKind::IF_ELSE_STATEMENT;
+
     using IfStatement::loc_;
     using IfStatement::condition_;
     using IfStatement::trueBlock_;
 
     Statement* falseBlock_ = nullptr;
 
-    IfElseStatement(const location& loc, Expression* condition, Statement* trueBlock, Statement* falseBlock) :
-        IfStatement(loc, condition, trueBlock), falseBlock_(falseBlock) {}
+    IfElseStatement(const SourceRange& loc, Expression* condition, Statement* trueBlock, Statement* falseBlock) :
+        IfStatement(kind, loc, condition, trueBlock), falseBlock_(falseBlock) {}
 };
 
 struct WhileStatement : public Statement
 {
+    static constexpr NodeKind kind = NodeKind::WHILE_STATEMENT;
+
     using Statement::loc_;
 
     Expression* condition_ = nullptr;
     Statement* block_ = nullptr;
 
-    WhileStatement(const location& loc, Expression* condition, Statement* block) :
-        Statement(loc), condition_(condition), block_(block) {}
+    WhileStatement(const SourceRange& loc, Expression* condition, Statement* block) :
+        Statement(kind, loc), condition_(condition), block_(block) {}
 };
 
 struct OutputStatement : public Statement
 {
+    static constexpr NodeKind kind = NodeKind::OUTPUT_STATEMENT;
+
     using Statement::loc_;
 
     Expression* expr_;
 
-    OutputStatement(const location& loc, Expression* expr) :
-        Statement(loc), expr_(expr) {}
+    OutputStatement(const SourceRange& loc, Expression* expr) :
+        Statement(kind, loc), expr_(expr) {}
 };
 
 struct BreakStatement : public Statement
 {
+    static constexpr NodeKind kind = NodeKind::BREAK_STATEMENT;
+
     using Statement::loc_;
 
     WhileStatement* whileStat = nullptr;
 
-    BreakStatement(const location& loc) :
-        Statement(loc) {}
+    BreakStatement(const SourceRange& loc) :
+        Statement(kind, loc) {}
 };
 
 struct ContinueStatement : public Statement
 {
+    static constexpr NodeKind kind = NodeKind::CONTINUE_STATEMENT;
+
     using Statement::loc_;
 
     WhileStatement* whileStat = nullptr;
 
-    ContinueStatement(const location& loc) :
-        Statement(loc) {}
+    ContinueStatement(const SourceRange& loc) :
+        Statement(kind, loc) {}
 };
 
+template<typename NodeType>
+bool isa(const INode* node) {
+    return node->kind_ == NodeType::kind;
+}
+
 } // namespace paracl::frontend
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <deque>
+#include <string>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+
+namespace paracl::frontend
+{
+
+// Dense index of an interned identifier.
+using SymbolId = uint32_t;
+
+// Maps every distinct identifier to a SymbolId once, as it is lexed, so
+// that the AST and the symbol tables compare integers instead of strings.
+// Owned by the Driver; the names stay valid until clear().
+class Interner final
+{
+private:
+    // A deque never moves its elements, so the keys of ids_ stay valid.
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, SymbolId> ids_;
+
+public:
+    Interner() = default;
+
+    Interner(const Interner&) = delete;
+    Interner& operator=(const Interner&) = delete;
+
+    SymbolId intern(std::string_view name) {
+        auto found = ids_.find(name);
+        if (found != ids_.end()) {
+            return found->second;
+        }
+        auto id = static_cast<SymbolId>(names_.size());
+        ids_.emplace(names_.emplace_back(name), id);
+        return id;
+    }
+
+    std::string_view name(SymbolId id) const {
+        return names_[id];
+    }
+
+    // Number of distinct names, one past the largest SymbolId.
+    size_t size() const {
+        return names_.size();
+    }
+
+    void clear() {
+        ids_.clear();
+        names_.clear();
+    }
+};
+
+} // namespace paracl::frontend
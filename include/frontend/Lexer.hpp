@@ -1,5 +1,22 @@
 #pragma once
 
+#ifdef PARACL_HAND_LEXER
+
+#include "Scanner.hpp"
+
+namespace paracl::frontend
+{
+
+class Lexer final : public Scanner
+{
+public:
+    using Scanner::Scanner;
+};
+
+} // namespace paracl::frontend
+
+#else
+
 #if !defined(yyFlexLexerOnce)
 #include <FlexLexer.h>
 #endif
@@ -7,11 +24,10 @@
 #undef YY_DECL
 #define YY_DECL paracl::frontend::Parser::symbol_type paracl::frontend::Lexer::getNextToken()
 
-#include <fstream>
-
 #include "Driver.hpp"
+#include "SourceBuffer.hpp"
 #include "parser.tab.hh"
-#include "location.hpp"
+#include "Location.hpp"
 
 namespace paracl::frontend
 {
@@ -23,22 +39,53 @@ class Lexer final : public yyFlexLexer
 {
 private:
     Driver& driver_;
-    std::ifstream in_;
-    position curPos_;
+    // Null when the program is read from a stream.
+    SourceBuffer* source_ = nullptr;
+    LineIndex& lines_;
+    uint32_t offset_ = 0;
+
+    // Makes the source the scanner's only buffer, scanned in place
+    // without refills.
+    void scanInPlace();
+
+protected:
+    // Refills from the stream with whatever it has buffered.
+    int LexerInput(char* buf, int maxSize) override;
 
 public:
-    Lexer(Driver& driver, std::string* filepath)
-    : driver_(driver), in_(*filepath), curPos_(filepath) {
-        yyrestart(in_);
+    Lexer(Driver& driver, LineIndex& lines, SourceBuffer& source)
+    : driver_(driver), source_(std::addressof(source)), lines_(lines) {
+        scanInPlace();
     }
 
+    // Scans the program as the parser asks for tokens, for programs that
+    // are still being written to the stream.
+    Lexer(Driver& driver, LineIndex& lines, std::istream& in)
+    : yyFlexLexer(std::addressof(in), nullptr), driver_(driver), lines_(lines) {}
+
     Parser::symbol_type getNextToken();
 
-    location updateLocation() {
-        auto old_ = curPos_;
-        curPos_ += yyleng;
-        return location{old_, curPos_};
+    // True when program text has been read but not scanned yet, i.e. the
+    // next token does not have to wait for more input.
+    bool pending();
+
+    SourceRange updateLocation() {
+        uint32_t begin = offset_;
+        offset_ += static_cast<uint32_t>(yyleng);
+        return SourceRange{begin, offset_};
+    }
+
+    // Skips a run of line breaks, recording where the next lines start.
+    void newLines() {
+        for (int i = 0; i < yyleng; ++i) {
+            if (yytext[i] == '\n') {
+                lines_.addLine(offset_ + static_cast<uint32_t>(i) + 1);
+            }
+        }
+        offset_ += static_cast<uint32_t>(yyleng);
     }
 };
 
 } // namespace paracl::frontend
+
+#endif
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <ostream>
+#include <algorithm>
+
+namespace paracl::frontend
+{
+
+// Where a token or node is: byte offsets into the program text, end
+// exclusive. The parser's location type; Bison merges the locations of a
+// rule's symbols through begin and end, hence the names.
+struct SourceRange
+{
+    uint32_t begin = 0;
+    uint32_t end = 0;
+};
+
+// Offsets at which the lines of a program start, filled in by the lexer as
+// it skips newlines. Line and column are looked up only for diagnostics,
+// dumps and the bytecode's debug table.
+class LineIndex final
+{
+private:
+    const std::string* filename_;
+    std::vector<uint32_t> starts_{0};
+
+public:
+    struct Position
+    {
+        uint32_t line_;
+        uint32_t column_;
+    };
+
+    explicit LineIndex(const std::string* filename = nullptr)
+    : filename_(filename) {}
+
+    void addLine(uint32_t start) {
+        starts_.push_back(start);
+    }
+
+    // 1-based, like the columns of an editor counting bytes.
+    Position position(uint32_t offset) const {
+        auto next = std::upper_bound(starts_.begin(), starts_.end(), offset);
+        auto line = static_cast<uint32_t>(next - starts_.begin());
+        return Position{line, offset - *(next - 1) + 1};
+    }
+
+    // Same, starting from the line of the previous lookup: O(1) for a pass
+    // that goes through the program roughly in source order.
+    Position position(uint32_t offset, size_t& hint) const {
+        if (hint < starts_.size() && starts_[hint] <= offset) {
+            size_t last = std::min(hint + 4, starts_.size());
+            while (hint + 1 < last && starts_[hint + 1] <= offset) {
+                ++hint;
+            }
+            if (hint + 1 == starts_.size() || starts_[hint + 1] > offset) {
+                return Position{static_cast<uint32_t>(hint + 1), offset - starts_[hint] + 1};
+            }
+        }
+        Position pos = position(offset);
+        hint = pos.line_ - 1;
+        return pos;
+    }
+
+    // `file:line.column`, followed by the end of a longer range as in
+    // Bison's locations: `-column` on the same line, `-line.column` on
+    // another one.
+    void print(std::ostream& os, SourceRange range) const {
+        Position begin = position(range.begin);
+        Position end = position(std::max(range.begin, range.end));
+        uint32_t endColumn = end.column_ > 1 ? end.column_ - 1 : 0;
+        if (filename_) {
+            os << *filename_ << ':';
+        }
+        os << begin.line_ << '.' << begin.column_;
+        if (begin.line_ < end.line_) {
+            os << '-' << end.line_ << '.' << endColumn;
+        } else if (begin.column_ < endColumn) {
+            os << '-' << endColumn;
+        }
+    }
+
+    void clear() {
+        starts_.assign(1, 0);
+    }
+};
+
+} // namespace paracl::frontend
@@ -0,0 +1,812 @@
+#pragma once
+
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include <unordered_set>
+
+#include "NodeVisitor.hpp"
+#include "backend/ByteCode.hpp"
+
+namespace paracl::frontend
+{
+
+// Runs on an explicit work stack, like the semantic analyzer. Visiting a
+// node only pushes tasks: its children and the steps that emit the code
+// between and after them. Finished expressions leave their slot on a
+// stack and finished conditions their jumps to patch.
+class NodeCodeGenerator : public NodeVisitor
+{
+private:
+    using NodeVisitor::visit;
+    using Opcode = backend::Opcode;
+    using Instruction = backend::Instruction;
+
+    enum class Step : uint8_t
+    {
+        EXPRESSION,
+        STATEMENT,
+        // Compiles a condition into jumps taken when its truth equals b_.
+        BRANCH,
+        // Gives the instructions that follow back to the parent node.
+        LEAVE,
+        UNARY,
+        ASSIGN,
+        DISCARD,
+        LOGIC_LEFT,
+        LOGIC_RIGHT,
+        COPY_LEFT,
+        ARITHMETIC,
+        TERNARY_CONDITION,
+        TERNARY_TRUE,
+        TERNARY_FALSE,
+        BLOCK_END,
+        ELSE,
+        END_IF,
+        WHILE_BODY,
+        WHILE_TEST,
+        WHILE_END,
+        OUTPUT,
+        JOIN_BRANCHES,
+        SKIP_BRANCH,
+        COMPARE,
+        TEST_VALUE,
+    };
+
+    // a_ and b_ are what a step needs from when it was pushed: saved
+    // slot tops, jumps to patch, jumpIf.
+    struct Task
+    {
+        Step step_;
+        INode* node_;
+        int32_t a_;
+        int32_t b_;
+    };
+
+    struct Loop
+    {
+        WhileStatement* node_;
+        std::vector<size_t> breaks_;
+        std::vector<size_t> continues_;
+        int32_t top_ = 0;
+    };
+
+    backend::Program& program_;
+    const LineIndex* lines_;
+    size_t memoryLimit_;
+    // Frame offset of every enclosing block's variable array, by depth.
+    std::vector<int32_t> bases_;
+    std::vector<Loop> loops_;
+    std::vector<Task> tasks_;
+    std::vector<int32_t> slots_;
+    std::vector<std::vector<size_t>> branches_;
+
+    int32_t varTop_ = 0;
+    int32_t tempTop_ = 0;
+    // Index of the last instruction whose destination may be retargeted
+    // to a variable slot, so that `x = a + b` needs no extra MOV.
+    size_t retargetable_ = SIZE_MAX;
+    // Code size at the last label, so that peepholes never fuse an
+    // instruction that is a jump target.
+    size_t labelAt_ = SIZE_MAX;
+    // Source offset recorded for every emitted instruction, turned into
+    // lines and columns once the code is complete.
+    uint32_t where_ = 0;
+    std::vector<uint32_t> offsets_;
+    // Expressions that assign, increment, decrement or read input,
+    // themselves or in a subexpression.
+    std::unordered_set<const INode*> effects_;
+
+    void reserve(int32_t top) {
+        if (static_cast<uint32_t>(top) > program_.frameSize_) {
+            program_.frameSize_ = top;
+            checkMemory();
+        }
+    }
+
+    void checkMemory() const {
+        size_t memory = program_.frameSize_ * sizeof(int32_t) + program_.code_.size() * sizeof(Instruction);
+        if (memory > memoryLimit_) {
+            throw std::runtime_error("memory limit exceeded");
+        }
+    }
+
+    int32_t allocTemp() {
+        reserve(tempTop_ + 1);
+        return tempTop_++;
+    }
+
+    bool isTemp(int32_t slot) const {
+        return slot >= varTop_;
+    }
+
+    int32_t current() const {
+        return static_cast<int32_t>(program_.code_.size());
+    }
+
+    void emit(Opcode op, int32_t a = 0, int32_t b = 0, int32_t c = 0) {
+        program_.code_.push_back(Instruction{op, a, b, c});
+        offsets_.push_back(where_);
+        checkMemory();
+    }
+
+    void emitResult(Opcode op, int32_t a, int32_t b = 0, int32_t c = 0) {
+        emit(op, a, b, c);
+        retargetable_ = program_.code_.size() - 1;
+    }
+
+    size_t emitJump(Opcode op, int32_t cond = 0) {
+        emit(op, cond, 0, -1);
+        return program_.code_.size() - 1;
+    }
+
+    void patch(size_t jump, int32_t target) {
+        program_.code_[jump].c_ = target;
+    }
+
+    void label() {
+        retargetable_ = SIZE_MAX;
+        labelAt_ = program_.code_.size();
+    }
+
+    void patch(const std::vector<size_t>& jumps, int32_t target) {
+        for (auto jump: jumps) {
+            patch(jump, target);
+        }
+    }
+
+    size_t emitBranch(Opcode op, int32_t a, int32_t b) {
+        emit(op, a, b, -1);
+        return program_.code_.size() - 1;
+    }
+
+    // Register form, immediate form and the immediate form to use when
+    // the constant is on the left (`1 + x` -> ADDI, `1 < x` -> GTI).
+    struct Arithmetic
+    {
+        Opcode reg_;
+        Opcode imm_;
+        Opcode mirrored_;
+        bool mirrorable_;
+    };
+
+    static Arithmetic arithmetic(BinaryOperation op) {
+        switch (op) {
+        case BinaryOperation::BIN_MUL:
+            return {Opcode::MUL, Opcode::MULI, Opcode::MULI, true};
+        case BinaryOperation::BIN_DIV:
+            return {Opcode::DIV, Opcode::DIVI, Opcode::DIVI, false};
+        case BinaryOperation::BIN_MOD:
+            return {Opcode::MOD, Opcode::MODI, Opcode::MODI, false};
+        case BinaryOperation::BIN_ADD:
+            return {Opcode::ADD, Opcode::ADDI, Opcode::ADDI, true};
+        case BinaryOperation::BIN_SUB:
+            return {Opcode::SUB, Opcode::SUBI, Opcode::SUBI, false};
+        case BinaryOperation::BIN_L:
+            return {Opcode::LT, Opcode::LTI, Opcode::GTI, true};
+        case BinaryOperation::BIN_G:
+            return {Opcode::GT, Opcode::GTI, Opcode::LTI, true};
+        case BinaryOperation::BIN_LE:
+            return {Opcode::LE, Opcode::LEI, Opcode::GEI, true};
+        case BinaryOperation::BIN_GE:
+            return {Opcode::GE, Opcode::GEI, Opcode::LEI, true};
+        case BinaryOperation::BIN_EQ:
+            return {Opcode::EQ, Opcode::EQI, Opcode::EQI, true};
+        case BinaryOperation::BIN_NE:
+            return {Opcode::NE, Opcode::NEI, Opcode::NEI, true};
+        default:
+            throw std::runtime_error("Unknown binary operation");
+        }
+    }
+
+    // Fused compare-and-branch: register form, immediate form, and the
+    // immediate form to use when the constant is on the left.
+    struct Comparison
+    {
+        Opcode reg_;
+        Opcode imm_;
+        Opcode mirrored_;
+    };
+
+    static bool comparison(BinaryOperation op, bool jumpIf, Comparison& cmp) {
+        // Branching on a false condition is branching on the negated one.
+        if (!jumpIf) {
+            switch (op) {
+            case BinaryOperation::BIN_L: op = BinaryOperation::BIN_GE; break;
+            case BinaryOperation::BIN_G: op = BinaryOperation::BIN_LE; break;
+            case BinaryOperation::BIN_LE: op = BinaryOperation::BIN_G; break;
+            case BinaryOperation::BIN_GE: op = BinaryOperation::BIN_L; break;
+            case BinaryOperation::BIN_EQ: op = BinaryOperation::BIN_NE; break;
+            case BinaryOperation::BIN_NE: op = BinaryOperation::BIN_EQ; break;
+            default: return false;
+            }
+        }
+        switch (op) {
+        case BinaryOperation::BIN_L: cmp = {Opcode::JLT, Opcode::JLTI, Opcode::JGTI}; return true;
+        case BinaryOperation::BIN_G: cmp = {Opcode::JGT, Opcode::JGTI, Opcode::JLTI}; return true;
+        case BinaryOperation::BIN_LE: cmp = {Opcode::JLE, Opcode::JLEI, Opcode::JGEI}; return true;
+        case BinaryOperation::BIN_GE: cmp = {Opcode::JGE, Opcode::JGEI, Opcode::JLEI}; return true;
+        case BinaryOperation::BIN_EQ: cmp = {Opcode::JEQ, Opcode::JEQI, Opcode::JEQI}; return true;
+        case BinaryOperation::BIN_NE: cmp = {Opcode::JNE, Opcode::JNEI, Opcode::JNEI}; return true;
+        default: return false;
+        }
+    }
+
+    void findEffects(INode* root) {
+        effects_.clear();
+        for (INode* node: postOrder(root)) {
+            bool effect = false;
+            switch (node->kind_) {
+            case NodeKind::UNARY_EXPRESSION: {
+                UnaryOperation op = static_cast<UnaryExpression*>(node)->op_;
+                effect = op != UnaryOperation::UN_ADD && op != UnaryOperation::UN_SUB && op != UnaryOperation::UN_NOT;
+                break;
+            }
+            case NodeKind::BINARY_EXPRESSION:
+                effect = static_cast<BinaryExpression*>(node)->op_ == BinaryOperation::BIN_ASSIGN;
+                break;
+            case NodeKind::INPUT_EXPRESSION:
+                effect = true;
+                break;
+            default:
+                break;
+            }
+            for (size_t i = 0; !effect && childAt(node, i); ++i) {
+                effect = effects_.count(childAt(node, i)) != 0;
+            }
+            if (effect) {
+                effects_.insert(node);
+            }
+        }
+    }
+
+
+    static bool isConstant(Expression* expr) {
+        return isa<ConstantExpression>(expr);
+    }
+
+    static int32_t constant(Expression* expr) {
+        return static_cast<ConstantExpression*>(expr)->value_;
+    }
+
+    void push(Step step, INode* node, int32_t a = 0, int32_t b = 0) {
+        tasks_.push_back(Task{step, node, a, b});
+    }
+
+    void result(int32_t slot) {
+        slots_.push_back(slot);
+    }
+
+    int32_t operand() {
+        int32_t slot = slots_.back();
+        slots_.pop_back();
+        return slot;
+    }
+
+    std::vector<size_t> jumps() {
+        std::vector<size_t> jumps = std::move(branches_.back());
+        branches_.pop_back();
+        return jumps;
+    }
+
+    static int32_t index(size_t jump) {
+        return static_cast<int32_t>(jump);
+    }
+
+    // The instructions of a node are attributed to it until the tasks it
+    // pushes are done.
+    void enter(INode* node) {
+        push(Step::LEAVE, nullptr, static_cast<int32_t>(where_));
+        where_ = node->loc_.begin;
+    }
+
+    void run(Step step, INode* node) {
+        push(step, node);
+        while (!tasks_.empty()) {
+            Task task = tasks_.back();
+            tasks_.pop_back();
+            resume(task);
+        }
+    }
+
+    void resume(const Task& task) {
+        switch (task.step_) {
+        case Step::EXPRESSION:
+        case Step::STATEMENT:
+            enter(task.node_);
+            visit(task.node_);
+            return;
+        case Step::BRANCH:
+            enter(task.node_);
+            branch(static_cast<Expression*>(task.node_), task.b_);
+            return;
+        case Step::LEAVE:
+            where_ = static_cast<uint32_t>(task.a_);
+            return;
+        case Step::UNARY:
+            unary(static_cast<UnaryExpression*>(task.node_), task.a_);
+            return;
+        case Step::ASSIGN: {
+            int32_t var = operand();
+            int32_t value = operand();
+            tempTop_ = task.a_;
+            if (isTemp(value) && retargetable_ == program_.code_.size() - 1
+                && program_.code_.back().a_ == value) {
+                program_.code_.back().a_ = var;
+            } else if (value != var) {
+                emit(Opcode::MOV, var, value);
+            }
+            retargetable_ = SIZE_MAX;
+            result(var);
+            return;
+        }
+        case Step::DISCARD:
+            operand();
+            tempTop_ = task.a_;
+            return;
+        case Step::LOGIC_LEFT: {
+            auto node = static_cast<BinaryExpression*>(task.node_);
+            int32_t dst = task.a_;
+            emit(Opcode::BOOL, dst, operand());
+            size_t jump = emitJump(node->op_ == BinaryOperation::BIN_AND ? Opcode::JZ : Opcode::JNZ, dst);
+            tempTop_ = dst + 1;
+            push(Step::LOGIC_RIGHT, node, dst, index(jump));
+            push(Step::EXPRESSION, node->right_);
+            return;
+        }
+        case Step::LOGIC_RIGHT: {
+            int32_t dst = task.a_;
+            emit(Opcode::BOOL, dst, operand());
+            patch(static_cast<size_t>(task.b_), current());
+            label();
+            tempTop_ = dst + 1;
+            result(dst);
+            return;
+        }
+        case Step::COPY_LEFT:
+            // Operands are evaluated left to right, but a variable is read
+            // from its slot only when the operation runs: its value is
+            // copied before a right operand that may change it.
+            if (!isTemp(slots_.back())) {
+                int32_t copy = allocTemp();
+                emit(Opcode::MOV, copy, slots_.back());
+                slots_.back() = copy;
+            }
+            return;
+        case Step::ARITHMETIC:
+            arithmetic(static_cast<BinaryExpression*>(task.node_), task.a_);
+            return;
+        case Step::TERNARY_CONDITION: {
+            auto node = static_cast<TernaryExpression*>(task.node_);
+            int32_t dst = task.a_;
+            size_t onFalse = emitJump(Opcode::JZ, operand());
+            tempTop_ = dst + 1;
+            push(Step::TERNARY_TRUE, node, dst, index(onFalse));
+            push(Step::EXPRESSION, node->onTrue_);
+            return;
+        }
+        case Step::TERNARY_TRUE: {
+            auto node = static_cast<TernaryExpression*>(task.node_);
+            int32_t dst = task.a_;
+            emit(Opcode::MOV, dst, operand());
+            size_t end = emitJump(Opcode::JMP);
+            patch(static_cast<size_t>(task.b_), current());
+            tempTop_ = dst + 1;
+            push(Step::TERNARY_FALSE, node, dst, index(end));
+            push(Step::EXPRESSION, node->onFalse_);
+            return;
+        }
+        case Step::TERNARY_FALSE: {
+            int32_t dst = task.a_;
+            emit(Opcode::MOV, dst, operand());
+            patch(static_cast<size_t>(task.b_), current());
+            label();
+            tempTop_ = dst + 1;
+            result(dst);
+            return;
+        }
+        case Step::BLOCK_END:
+            bases_.pop_back();
+            varTop_ = task.a_;
+            tempTop_ = varTop_;
+            return;
+        case Step::ELSE: {
+            size_t end = emitJump(Opcode::JMP);
+            patch(jumps(), current());
+            label();
+            branches_.push_back({end});
+            return;
+        }
+        case Step::END_IF:
+            patch(jumps(), current());
+            label();
+            return;
+        case Step::WHILE_BODY:
+            loops_.push_back(Loop{static_cast<WhileStatement*>(task.node_), jumps(), {}, current()});
+            label();
+            return;
+        case Step::WHILE_TEST:
+            if (!loops_.back().continues_.empty()) {
+                patch(loops_.back().continues_, current());
+                label();
+            }
+            push(Step::BRANCH, static_cast<WhileStatement*>(task.node_)->condition_, 0, true);
+            return;
+        case Step::WHILE_END: {
+            std::vector<size_t> back = jumps();
+            patch(back, loops_.back().top_);
+            fuseDecrement(back);
+            patch(loops_.back().breaks_, current());
+            loops_.pop_back();
+            label();
+            return;
+        }
+        case Step::OUTPUT:
+            emit(Opcode::OUT, operand());
+            tempTop_ = task.a_;
+            return;
+        case Step::JOIN_BRANCHES: {
+            std::vector<size_t> right = jumps();
+            branches_.back().insert(branches_.back().end(), right.begin(), right.end());
+            return;
+        }
+        case Step::SKIP_BRANCH: {
+            std::vector<size_t> taken = jumps();
+            patch(jumps(), current());
+            label();
+            branches_.push_back(std::move(taken));
+            return;
+        }
+        case Step::COMPARE:
+            compare(static_cast<BinaryExpression*>(task.node_), task.a_, task.b_);
+            return;
+        case Step::TEST_VALUE: {
+            int32_t cond = operand();
+            tempTop_ = task.a_;
+            branches_.push_back({emitJump(task.b_ ? Opcode::JNZ : Opcode::JZ, cond)});
+            return;
+        }
+        }
+    }
+
+    // Pushes the operands of a binary operation in the form it compiles
+    // to: only the left one before an immediate, only the right one when
+    // the constant on the left mirrors, both otherwise.
+    void operands(Step step, BinaryExpression* node, bool mirrorable, int32_t saved, int32_t b = 0) {
+        push(step, node, saved, b);
+        if (isConstant(node->right_)) {
+            push(Step::EXPRESSION, node->left_);
+        } else if (mirrorable && isConstant(node->left_)) {
+            push(Step::EXPRESSION, node->right_);
+        } else {
+            push(Step::EXPRESSION, node->right_);
+            if (effects_.count(node->right_)) {
+                push(Step::COPY_LEFT, node);
+            }
+            push(Step::EXPRESSION, node->left_);
+        }
+    }
+
+    void unary(UnaryExpression* node, int32_t saved) {
+        int32_t expr = operand();
+        tempTop_ = saved;
+        int32_t dst;
+        switch (node->op_) {
+        case UnaryOperation::UN_ADD:
+            // The operand's temporary is the result and stays live.
+            if (expr >= saved) {
+                tempTop_ = expr + 1;
+            }
+            result(expr);
+            return;
+        case UnaryOperation::UN_SUB:
+            dst = allocTemp();
+            emitResult(Opcode::NEG, dst, expr);
+            result(dst);
+            return;
+        case UnaryOperation::UN_NOT:
+            dst = allocTemp();
+            emitResult(Opcode::NOT, dst, expr);
+            result(dst);
+            return;
+        case UnaryOperation::UN_PREFIX_INC:
+            emit(Opcode::INC, expr);
+            result(expr);
+            return;
+        case UnaryOperation::UN_PREFIX_DEC:
+            emit(Opcode::DEC, expr);
+            result(expr);
+            return;
+        case UnaryOperation::UN_POSTFIX_INC:
+            dst = allocTemp();
+            emit(Opcode::MOV, dst, expr);
+            emit(Opcode::INC, expr);
+            result(dst);
+            return;
+        case UnaryOperation::UN_POSTFIX_DEC:
+            dst = allocTemp();
+            emit(Opcode::MOV, dst, expr);
+            emit(Opcode::DEC, expr);
+            result(dst);
+            return;
+        }
+    }
+
+    void arithmetic(BinaryExpression* node, int32_t saved) {
+        Arithmetic ops = arithmetic(node->op_);
+        int32_t dst;
+        if (isConstant(node->right_)) {
+            int32_t left = operand();
+            tempTop_ = saved;
+            dst = allocTemp();
+            emitResult(ops.imm_, dst, left, constant(node->right_));
+        } else if (ops.mirrorable_ && isConstant(node->left_)) {
+            int32_t right = operand();
+            tempTop_ = saved;
+            dst = allocTemp();
+            emitResult(ops.mirrored_, dst, right, constant(node->left_));
+        } else {
+            int32_t right = operand();
+            int32_t left = operand();
+            tempTop_ = saved;
+            dst = allocTemp();
+            emitResult(ops.reg_, dst, left, right);
+        }
+        result(dst);
+    }
+
+    // Conditions compile straight into jumps taken when their truth equals
+    // jumpIf; control falls through otherwise. Comparisons become fused
+    // compare-and-branch instructions and `&&`/`||` never materialize a
+    // boolean.
+    void branch(Expression* expr, bool jumpIf) {
+        if (isConstant(expr)) {
+            if ((constant(expr) != 0) != jumpIf) {
+                branches_.emplace_back();
+            } else {
+                branches_.push_back({emitJump(Opcode::JMP)});
+            }
+            return;
+        }
+        if (isa<UnaryExpression>(expr)) {
+            auto unary = static_cast<UnaryExpression*>(expr);
+            if (unary->op_ == UnaryOperation::UN_NOT) {
+                push(Step::BRANCH, unary->expr_, 0, !jumpIf);
+                return;
+            }
+        }
+        if (isa<BinaryExpression>(expr)) {
+            auto binary = static_cast<BinaryExpression*>(expr);
+            BinaryOperation op = binary->op_;
+            if (op == BinaryOperation::BIN_AND || op == BinaryOperation::BIN_OR) {
+                // `a && b` jumps on false from either operand; on true it
+                // needs both, so a false `a` skips the test of `b`.
+                bool shortCircuit = op == BinaryOperation::BIN_OR;
+                if (jumpIf == shortCircuit) {
+                    push(Step::JOIN_BRANCHES, binary);
+                    push(Step::BRANCH, binary->right_, 0, jumpIf);
+                    push(Step::BRANCH, binary->left_, 0, jumpIf);
+                } else {
+                    push(Step::SKIP_BRANCH, binary);
+                    push(Step::BRANCH, binary->right_, 0, jumpIf);
+                    push(Step::BRANCH, binary->left_, 0, !jumpIf);
+                }
+                return;
+            }
+            Comparison cmp{};
+            if (comparison(op, jumpIf, cmp)) {
+                operands(Step::COMPARE, binary, true, tempTop_, jumpIf);
+                return;
+            }
+        }
+        push(Step::TEST_VALUE, expr, tempTop_, jumpIf);
+        push(Step::EXPRESSION, expr);
+    }
+
+    void compare(BinaryExpression* node, int32_t saved, bool jumpIf) {
+        // branch() only pushes comparisons.
+        Comparison cmp{};
+        [[maybe_unused]] bool fused = comparison(node->op_, jumpIf, cmp);
+        assert(fused);
+        size_t jump;
+        if (isConstant(node->right_)) {
+            jump = emitBranch(cmp.imm_, operand(), constant(node->right_));
+        } else if (isConstant(node->left_)) {
+            jump = emitBranch(cmp.mirrored_, operand(), constant(node->left_));
+        } else {
+            int32_t right = operand();
+            int32_t left = operand();
+            jump = emitBranch(cmp.reg_, left, right);
+        }
+        tempTop_ = saved;
+        branches_.push_back({jump});
+    }
+
+
+    // `while (--n)` and `while (n = n - 1)` end in a decrement followed by
+    // a branch on the same slot; both become a single DEC_JNZ. Not when a
+    // jump lands on the branch or just past it, as the false exit of
+    // `while (a && --n)` does: removing the branch would move its target.
+    void fuseDecrement(const std::vector<size_t>& back) {
+        if (back.size() != 1 || back[0] != program_.code_.size() - 1 || back[0] == 0
+            || (labelAt_ != SIZE_MAX && labelAt_ >= back[0])) {
+            return;
+        }
+        Instruction jump = program_.code_[back[0]];
+        Instruction& prev = program_.code_[back[0] - 1];
+        bool decrement = (prev.op_ == Opcode::DEC && prev.a_ == jump.a_)
+            || (prev.op_ == Opcode::SUBI && prev.a_ == jump.a_ && prev.b_ == jump.a_ && prev.c_ == 1);
+        if (jump.op_ != Opcode::JNZ || !decrement) {
+            return;
+        }
+        prev = Instruction{Opcode::DEC_JNZ, jump.a_, 0, jump.c_};
+        program_.code_.pop_back();
+        offsets_.pop_back();
+    }
+
+    void locate() {
+        program_.locations_.clear();
+        if (!lines_) {
+            return;
+        }
+        program_.locations_.reserve(offsets_.size());
+        size_t line = 0;
+        for (uint32_t offset: offsets_) {
+            LineIndex::Position pos = lines_->position(offset, line);
+            program_.locations_.push_back(backend::SourceLocation{pos.line_, pos.column_});
+        }
+    }
+
+public:
+    // Without the lines of the source the program gets no debug table.
+    // Generation throws std::runtime_error once the frame and the code
+    // would take more than memoryLimit bytes.
+    NodeCodeGenerator(backend::Program& program, const LineIndex* lines = nullptr,
+                      size_t memoryLimit = SIZE_MAX)
+    : program_(program), lines_(lines), memoryLimit_(memoryLimit) {}
+
+    void generate(INode* root) {
+        program_.code_.clear();
+        offsets_.clear();
+        program_.frameSize_ = 0;
+        if (root) {
+            findEffects(root);
+            run(Step::STATEMENT, root);
+        }
+        emit(Opcode::HALT);
+        locate();
+    }
+
+    // Compiles one top-level statement of a streamed program. The globals
+    // declared so far keep their slots at the start of the frame, so
+    // statements compiled one by one share them. A statement the optimizer
+    // removed is null.
+    void generate(const BlockStatement* globals, Statement* statement) {
+        program_.code_.clear();
+        offsets_.clear();
+        program_.frameSize_ = 0;
+        varTop_ = static_cast<int32_t>(globals->table_.size());
+        reserve(varTop_);
+        tempTop_ = varTop_;
+        if (statement) {
+            bases_.push_back(0);
+            findEffects(statement);
+            run(Step::STATEMENT, statement);
+            bases_.pop_back();
+        }
+        emit(Opcode::HALT);
+        locate();
+    }
+
+protected:
+    void visit(UnaryExpression* node) override {
+        push(Step::UNARY, node, tempTop_);
+        push(Step::EXPRESSION, node->expr_);
+    }
+
+    void visit(BinaryExpression* node) override {
+        int32_t saved = tempTop_;
+        switch (node->op_) {
+        case BinaryOperation::BIN_ASSIGN:
+            push(Step::ASSIGN, node, saved);
+            push(Step::EXPRESSION, node->left_);
+            push(Step::EXPRESSION, node->right_);
+            return;
+        case BinaryOperation::BIN_COMMA:
+            push(Step::EXPRESSION, node->right_);
+            push(Step::DISCARD, node, saved);
+            push(Step::EXPRESSION, node->left_);
+            return;
+        case BinaryOperation::BIN_AND:
+        case BinaryOperation::BIN_OR:
+            push(Step::LOGIC_LEFT, node, allocTemp());
+            push(Step::EXPRESSION, node->left_);
+            return;
+        default:
+            operands(Step::ARITHMETIC, node, arithmetic(node->op_).mirrorable_, saved);
+            return;
+        }
+    }
+
+    void visit(TernaryExpression* node) override {
+        push(Step::TERNARY_CONDITION, node, allocTemp());
+        push(Step::EXPRESSION, node->condition_);
+    }
+
+    void visit(ConstantExpression* node) override {
+        int32_t dst = allocTemp();
+        emitResult(Opcode::LOADI, dst, node->value_);
+        result(dst);
+    }
+
+    void visit(VariableExpression* node) override {
+        assert(node->depth_ >= 0 && static_cast<size_t>(node->depth_) < bases_.size());
+        result(bases_[node->depth_] + node->slot_);
+    }
+
+    void visit(InputExpression* ) override {
+        int32_t dst = allocTemp();
+        emitResult(Opcode::IN, dst);
+        result(dst);
+    }
+
+    void visit(BlockStatement* node) override {
+        push(Step::BLOCK_END, node, varTop_);
+        bases_.push_back(varTop_);
+        varTop_ += static_cast<int32_t>(node->table_.size());
+        reserve(varTop_);
+        tempTop_ = varTop_;
+        for (auto it = node->statements_.rbegin(); it != node->statements_.rend(); ++it) {
+            push(Step::STATEMENT, *it);
+        }
+    }
+
+    void visit(ExpressionStatement* node) override {
+        push(Step::DISCARD, node, tempTop_);
+        push(Step::EXPRESSION, node->expr_);
+    }
+
+    void visit(IfStatement* node) override {
+        push(Step::END_IF, node);
+        push(Step::STATEMENT, node->trueBlock_);
+        push(Step::BRANCH, node->condition_, 0, false);
+    }
+
+    void visit(IfElseStatement* node) override {
+        push(Step::END_IF, node);
+        push(Step::STATEMENT, node->falseBlock_);
+        push(Step::ELSE, node);
+        push(Step::STATEMENT, node->trueBlock_);
+        push(Step::BRANCH, node->condition_, 0, false);
+    }
+
+    // Loops are rotated: the condition is tested once on entry and then at
+    // the bottom, so every iteration takes a single backward branch.
+    void visit(WhileStatement* node) override {
+        label();
+        push(Step::WHILE_END, node);
+        push(Step::WHILE_TEST, node);
+        push(Step::STATEMENT, node->block_);
+        push(Step::WHILE_BODY, node);
+        push(Step::BRANCH, node->condition_, 0, false);
+    }
+
+    void visit(OutputStatement* node) override {
+        push(Step::OUTPUT, node, tempTop_);
+        push(Step::EXPRESSION, node->expr_);
+    }
+
+    void visit([[maybe_unused]] BreakStatement* node) override {
+        assert(!loops_.empty() && loops_.back().node_ == node->whileStat);
+        loops_.back().breaks_.push_back(emitJump(Opcode::JMP));
+    }
+
+    void visit([[maybe_unused]] ContinueStatement* node) override {
+        assert(!loops_.empty() && loops_.back().node_ == node->whileStat);
+        loops_.back().continues_.push_back(emitJump(Opcode::JMP));
+    }
+};
+
+} // namespace paracl::frontend
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <vector>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+
 #include "NodeVisitor.hpp"
 
 namespace paracl::frontend
@@ -8,21 +13,61 @@ namespace paracl::frontend
 class NodeCopier : public NodeVisitor
 {
 private:
-    using NodeVisitor::postOrderTraversal;
+    using NodeVisitor::postOrder;
     using NodeVisitor::visit;
 
+    template<typename NodeType>
+    using Copies = std::vector<std::pair<NodeType*, NodeType*>>;
+
     AST& tree_;
     std::vector<INode*> copied_;
+    // Original -> copy links, resolved once the whole tree is copied, so
+    // that copying does not allocate per node.
+    Copies<VariableExpression> variables_;
+    Copies<WhileStatement> whiles_;
+    Copies<BlockStatement> blocks_;
+    std::vector<BreakStatement*> breaks_;
+    std::vector<ContinueStatement*> continues_;
+
+    template<typename NodeType>
+    static NodeType* copyOf(const Copies<NodeType>& copies, NodeType* original) {
+        auto found = std::lower_bound(copies.begin(), copies.end(), std::make_pair(original, nullptr),
+            [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+        assert(found != copies.end() && found->first == original);
+        return found->second;
+    }
+
+    void link() {
+        std::sort(variables_.begin(), variables_.end());
+        std::sort(whiles_.begin(), whiles_.end());
+        for (auto [original, block]: blocks_) {
+            for (auto& [name, var]: original->table_) {
+                VariableExpression* copy = copyOf(variables_, var);
+                block->table_.declare(copy->name_, copy);
+            }
+        }
+        for (auto breakStat: breaks_) {
+            breakStat->whileStat = copyOf(whiles_, breakStat->whileStat);
+        }
+        for (auto continueStat: continues_) {
+            continueStat->whileStat = copyOf(whiles_, continueStat->whileStat);
+        }
+    }
 
 public:
-    NodeCopier(AST& tree)
-    : tree_(tree) {}
+    NodeCopier(AST& tree, size_t sizeHint = 0)
+    : tree_(tree) {
+        variables_.reserve(sizeHint / 4);
+    }
 
     INode* copy(INode* root) {
-        auto nodes = postOrderTraversal(root);
-        for (auto& node: nodes) {
+        if (!root) {
+            return nullptr;
+        }
+        for (INode* node: postOrder(root)) {
             visit(node);
         }
+        link();
         return copied_.back();
     }
 
@@ -61,6 +106,9 @@ protected:
 
     void visit(VariableExpression* node) override {
         VariableExpression* var = tree_.createNode<VariableExpression>(node->loc_, node->name_);
+        var->depth_ = node->depth_;
+        var->slot_ = node->slot_;
+        variables_.emplace_back(node, var);
         copied_.push_back(var);
     }
 
@@ -76,6 +124,9 @@ protected:
             copied_.pop_back();
             block->statements_.push_front(stat);
         }
+        if (node->table_.size()) {
+            blocks_.emplace_back(node, block);
+        }
         copied_.push_back(block);
     }
 
@@ -112,6 +163,7 @@ protected:
         Expression* condition = static_cast<Expression*>(copied_.back());
         copied_.pop_back();
         WhileStatement* whileStat = tree_.createNode<WhileStatement>(node->loc_, condition, block);
+        whiles_.emplace_back(node, whileStat);
         copied_.push_back(whileStat);
     }
 
@@ -124,11 +176,19 @@ protected:
 
     void visit(BreakStatement* node) override {
         BreakStatement* breakStat = tree_.createNode<BreakStatement>(node->loc_);
+        if (node->whileStat) {
+            breakStat->whileStat = node->whileStat;
+            breaks_.push_back(breakStat);
+        }
         copied_.push_back(breakStat);
     }
 
     void visit(ContinueStatement* node) override {
         ContinueStatement* continueStat = tree_.createNode<ContinueStatement>(node->loc_);
+        if (node->whileStat) {
+            continueStat->whileStat = node->whileStat;
+            continues_.push_back(continueStat);
+        }
         copied_.push_back(continueStat);
     }
 };
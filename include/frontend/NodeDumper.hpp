@@ -11,17 +11,24 @@ namespace paracl::frontend
 class NodeDumper : public NodeVisitor
 {
 private:
-    using NodeVisitor::postOrderTraversal;
+    using NodeVisitor::postOrder;
     using NodeVisitor::visit;
 
     std::ostream& os_;
+    const Interner& names_;
+    const LineIndex* lines_;
 
     void printLink(INode* parent, INode* child) {
         os_ << "\tnode_" << parent << " -> node_" << child << ";\n";
     }
 
     void printNode(INode* node, const std::string& color, const std::string& label) {
-        os_ << "\tnode_" << node << "[fillcolor=" << color << ", label = \"" << node->loc_ << " | " << label << "\"];\n";
+        os_ << "\tnode_" << node << "[fillcolor=" << color << ", label = \"";
+        if (lines_) {
+            lines_->print(os_, node->loc_);
+            os_ << " | ";
+        }
+        os_ << label << "\"];\n";
     }
 
     std::string unOper(UnaryOperation op) {
@@ -83,15 +90,16 @@ private:
     }
 
 public:
-    NodeDumper(std::ostream& os)
-    : os_(os) {}
+    NodeDumper(std::ostream& os, const Interner& names, const LineIndex* lines = nullptr)
+    : os_(os), names_(names), lines_(lines) {}
 
     void dump(INode* root) {
         os_ << "digraph {\n";
         os_ << "\tnode[shape=record, style=filled, fontcolor=black];\n";
-        auto nodes = postOrderTraversal(root);
-        for (auto node: nodes) {
-            visit(node);
+        if (root) {
+            for (INode* node: postOrder(root)) {
+                visit(node);
+            }
         }
         os_ << "}" << std::endl;
     }
@@ -120,7 +128,7 @@ protected:
     }
 
     virtual void visit(VariableExpression* node) {
-        printNode(node, "pink", node->name_);
+        printNode(node, "pink", std::string{names_.name(node->name_)});
     }
 
     virtual void visit(InputExpression* node) {
@@ -0,0 +1,165 @@
+#pragma once
+
+#include <vector>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+#include <functional>
+
+#include "FlatAST.hpp"
+#include "NodeVisitor.hpp"
+
+namespace paracl::frontend
+{
+
+// Converts an AST into a FlatAST. The pointer tree is walked in
+// post-order, so every node gets its id after its children; ids of
+// finished subtrees wait on a stack until their parent takes them.
+class NodeFlattener : public NodeVisitor
+{
+private:
+    using NodeVisitor::postOrder;
+    using NodeVisitor::visit;
+
+    FlatAST& flat_;
+    std::vector<NodeId> ids_;
+    // A loop is flattened after the breaks and continues inside it, so
+    // those are linked once the whole tree is done.
+    std::vector<std::pair<WhileStatement*, NodeId>> whiles_;
+    std::vector<std::pair<NodeId, WhileStatement*>> jumps_;
+
+    NodeId pop() {
+        NodeId id = ids_.back();
+        ids_.pop_back();
+        return id;
+    }
+
+    void push(NodeId id) {
+        ids_.push_back(id);
+    }
+
+    static uint8_t op(auto operation) {
+        return static_cast<uint8_t>(operation);
+    }
+
+    // Unrelated pointers are only ordered by std::less, not by `<`.
+    void link() {
+        auto byLoop = [](const auto& lhs, const auto& rhs) {
+            return std::less<WhileStatement*>{}(lhs.first, rhs.first);
+        };
+        std::sort(whiles_.begin(), whiles_.end(), byLoop);
+        for (auto [jump, original]: jumps_) {
+            auto found = std::lower_bound(whiles_.begin(), whiles_.end(), std::make_pair(original, NodeId{0}), byLoop);
+            assert(found != whiles_.end() && found->first == original);
+            flat_.setOperand(jump, 0, found->second);
+        }
+    }
+
+public:
+    NodeFlattener(FlatAST& flat, size_t sizeHint = 0)
+    : flat_(flat) {
+        flat_.reserve(sizeHint);
+    }
+
+    // Returns the id of the root, noNode for an empty tree.
+    NodeId flatten(INode* root) {
+        if (!root) {
+            return noNode;
+        }
+        for (INode* node: postOrder(root)) {
+            visit(node);
+        }
+        link();
+        return pop();
+    }
+
+protected:
+    void visit(UnaryExpression* node) override {
+        NodeId expr = pop();
+        push(flat_.add(node->kind_, node->loc_, op(node->op_), expr));
+    }
+
+    void visit(BinaryExpression* node) override {
+        NodeId right = pop();
+        NodeId left = pop();
+        push(flat_.add(node->kind_, node->loc_, op(node->op_), left, right));
+    }
+
+    void visit(TernaryExpression* node) override {
+        NodeId onFalse = pop();
+        NodeId onTrue = pop();
+        NodeId condition = pop();
+        push(flat_.add(node->kind_, node->loc_, 0, condition, onTrue, onFalse));
+    }
+
+    void visit(ConstantExpression* node) override {
+        push(flat_.add(node->kind_, node->loc_, 0, static_cast<uint32_t>(node->value_)));
+    }
+
+    void visit(VariableExpression* node) override {
+        push(flat_.add(node->kind_, node->loc_, 0, node->name_,
+                       static_cast<uint32_t>(node->depth_), static_cast<uint32_t>(node->slot_)));
+    }
+
+    void visit(InputExpression* node) override {
+        push(flat_.add(node->kind_, node->loc_));
+    }
+
+    void visit(BlockStatement* node) override {
+        size_t count = node->statements_.size();
+        std::span<const NodeId> statements{ids_.end() - static_cast<std::ptrdiff_t>(count), ids_.end()};
+        uint32_t first = flat_.addChildren(statements);
+        ids_.resize(ids_.size() - count);
+        push(flat_.add(node->kind_, node->loc_, 0, first, static_cast<uint32_t>(count),
+                       static_cast<uint32_t>(node->table_.size())));
+    }
+
+    void visit(ExpressionStatement* node) override {
+        NodeId expr = pop();
+        push(flat_.add(node->kind_, node->loc_, 0, expr));
+    }
+
+    void visit(IfStatement* node) override {
+        NodeId trueBlock = pop();
+        NodeId condition = pop();
+        push(flat_.add(node->kind_, node->loc_, 0, condition, trueBlock));
+    }
+
+    void visit(IfElseStatement* node) override {
+        NodeId falseBlock = pop();
+        NodeId trueBlock = pop();
+        NodeId condition = pop();
+        push(flat_.add(node->kind_, node->loc_, 0, condition, trueBlock, falseBlock));
+    }
+
+    void visit(WhileStatement* node) override {
+        NodeId block = pop();
+        NodeId condition = pop();
+        NodeId id = flat_.add(node->kind_, node->loc_, 0, condition, block);
+        whiles_.emplace_back(node, id);
+        push(id);
+    }
+
+    void visit(OutputStatement* node) override {
+        NodeId expr = pop();
+        push(flat_.add(node->kind_, node->loc_, 0, expr));
+    }
+
+    void visit(BreakStatement* node) override {
+        NodeId id = flat_.add(node->kind_, node->loc_);
+        if (node->whileStat) {
+            jumps_.emplace_back(id, node->whileStat);
+        }
+        push(id);
+    }
+
+    void visit(ContinueStatement* node) override {
+        NodeId id = flat_.add(node->kind_, node->loc_);
+        if (node->whileStat) {
+            jumps_.emplace_back(id, node->whileStat);
+        }
+        push(id);
+    }
+};
+
+} // namespace paracl::frontend
@@ -0,0 +1,543 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <llvm/IR/IRBuilder.h>
+#include <llvm/IR/LLVMContext.h>
+#include <llvm/IR/Module.h>
+#include <llvm/IR/Verifier.h>
+#include <llvm/Support/raw_ostream.h>
+
+#include "NodeVisitor.hpp"
+
+namespace paracl::frontend
+{
+
+// Lowers an analyzed AST to an LLVM module with a single `i32 main()`.
+// Every variable gets an alloca in the entry block (mem2reg turns them
+// into SSA values), `&&`, `||` and `?:` become branches, and `?`/`print`
+// call small runtime shims defined in the module itself on top of libc,
+// so the same module runs under ORC JIT and links into an executable.
+// Arithmetic wraps like in the VM, division by zero aborts with the
+// VM's message and INT_MIN / -1 wraps instead of trapping.
+//
+// Like the bytecode generator it runs on an explicit work stack: a visit
+// pushes the children and the steps that emit the IR between and after
+// them, and finished expressions leave their value on a stack.
+class NodeIRGenerator : public NodeVisitor
+{
+private:
+    using NodeVisitor::visit;
+
+    enum class Step : uint8_t
+    {
+        EXPRESSION,
+        STATEMENT,
+        UNARY,
+        ASSIGN,
+        DISCARD,
+        LOGIC_LEFT,
+        LOGIC_RIGHT,
+        ARITHMETIC,
+        TERNARY_CONDITION,
+        TERNARY_TRUE,
+        TERNARY_FALSE,
+        BLOCK_END,
+        // Branches to first_ or second_ on the value of a condition and
+        // continues in first_.
+        BRANCH,
+        ELSE,
+        END_IF,
+        WHILE_END,
+        OUTPUT,
+    };
+
+    // The blocks a step continues with, created when it was pushed.
+    struct Task
+    {
+        Step step_;
+        INode* node_;
+        llvm::BasicBlock* first_;
+        llvm::BasicBlock* second_;
+    };
+
+    struct Loop
+    {
+        llvm::BasicBlock* continue_;
+        llvm::BasicBlock* break_;
+    };
+
+    llvm::LLVMContext& context_;
+    const Interner& names_;
+    const LineIndex& lines_;
+    std::unique_ptr<llvm::Module> module_;
+    llvm::IRBuilder<> builder_;
+    llvm::IRBuilder<> allocas_;
+
+    llvm::Type* i32_ = nullptr;
+    llvm::Function* main_ = nullptr;
+    llvm::Function* print_ = nullptr;
+    llvm::Function* input_ = nullptr;
+    llvm::Function* fail_ = nullptr;
+
+    // Allocas of every enclosing block's variables, by depth.
+    std::vector<std::vector<llvm::AllocaInst*>> scopes_;
+    std::vector<Loop> loops_;
+    std::vector<Task> tasks_;
+    std::vector<llvm::Value*> values_;
+    std::unordered_map<std::string, llvm::Constant*> strings_;
+
+    void push(Step step, INode* node, llvm::BasicBlock* first = nullptr, llvm::BasicBlock* second = nullptr) {
+        tasks_.push_back(Task{step, node, first, second});
+    }
+
+    void result(llvm::Value* value) {
+        values_.push_back(value);
+    }
+
+    llvm::Value* operand() {
+        llvm::Value* value = values_.back();
+        values_.pop_back();
+        return value;
+    }
+
+    void run(Step step, INode* node) {
+        push(step, node);
+        while (!tasks_.empty()) {
+            Task task = tasks_.back();
+            tasks_.pop_back();
+            resume(task);
+        }
+    }
+
+    void resume(const Task& task) {
+        switch (task.step_) {
+        case Step::EXPRESSION:
+        case Step::STATEMENT:
+            visit(task.node_);
+            return;
+        case Step::UNARY:
+            unary(static_cast<UnaryExpression*>(task.node_), operand());
+            return;
+        case Step::ASSIGN: {
+            auto node = static_cast<BinaryExpression*>(task.node_);
+            llvm::Value* value = operand();
+            builder_.CreateStore(value, variable(static_cast<VariableExpression*>(node->left_)));
+            result(value);
+            return;
+        }
+        case Step::DISCARD:
+            operand();
+            return;
+        case Step::LOGIC_LEFT: {
+            auto node = static_cast<BinaryExpression*>(task.node_);
+            bool isAnd = node->op_ == BinaryOperation::BIN_AND;
+            llvm::Value* left = truth(operand());
+            auto from = builder_.GetInsertBlock();
+            auto rhs = block(isAnd ? "and.rhs" : "or.rhs");
+            auto end = block(isAnd ? "and.end" : "or.end");
+            if (isAnd) {
+                builder_.CreateCondBr(left, rhs, end);
+            } else {
+                builder_.CreateCondBr(left, end, rhs);
+            }
+            builder_.SetInsertPoint(rhs);
+            push(Step::LOGIC_RIGHT, node, from, end);
+            push(Step::EXPRESSION, node->right_);
+            return;
+        }
+        case Step::LOGIC_RIGHT: {
+            bool isAnd = static_cast<BinaryExpression*>(task.node_)->op_ == BinaryOperation::BIN_AND;
+            llvm::Value* right = truth(operand());
+            auto rhsEnd = builder_.GetInsertBlock();
+            builder_.CreateBr(task.second_);
+            builder_.SetInsertPoint(task.second_);
+            auto phi = builder_.CreatePHI(builder_.getInt1Ty(), 2);
+            phi->addIncoming(builder_.getInt1(!isAnd), task.first_);
+            phi->addIncoming(right, rhsEnd);
+            result(widen(phi));
+            return;
+        }
+        case Step::ARITHMETIC: {
+            auto node = static_cast<BinaryExpression*>(task.node_);
+            llvm::Value* right = operand();
+            llvm::Value* left = operand();
+            result(arithmetic(node->op_, left, right, node->loc_));
+            return;
+        }
+        case Step::TERNARY_CONDITION: {
+            auto node = static_cast<TernaryExpression*>(task.node_);
+            llvm::Value* condition = truth(operand());
+            auto onTrue = block("cond.true");
+            auto onFalse = block("cond.false");
+            auto end = block("cond.end");
+            builder_.CreateCondBr(condition, onTrue, onFalse);
+            builder_.SetInsertPoint(onTrue);
+            push(Step::TERNARY_TRUE, node, onFalse, end);
+            push(Step::EXPRESSION, node->onTrue_);
+            return;
+        }
+        case Step::TERNARY_TRUE: {
+            auto node = static_cast<TernaryExpression*>(task.node_);
+            auto trueEnd = builder_.GetInsertBlock();
+            builder_.CreateBr(task.second_);
+            builder_.SetInsertPoint(task.first_);
+            push(Step::TERNARY_FALSE, node, task.second_, trueEnd);
+            push(Step::EXPRESSION, node->onFalse_);
+            return;
+        }
+        case Step::TERNARY_FALSE: {
+            llvm::Value* falseValue = operand();
+            llvm::Value* trueValue = operand();
+            auto falseEnd = builder_.GetInsertBlock();
+            builder_.CreateBr(task.first_);
+            builder_.SetInsertPoint(task.first_);
+            auto phi = builder_.CreatePHI(i32_, 2);
+            phi->addIncoming(trueValue, task.second_);
+            phi->addIncoming(falseValue, falseEnd);
+            result(phi);
+            return;
+        }
+        case Step::BLOCK_END:
+            scopes_.pop_back();
+            return;
+        case Step::BRANCH:
+            builder_.CreateCondBr(truth(operand()), task.first_, task.second_);
+            builder_.SetInsertPoint(task.first_);
+            return;
+        case Step::ELSE:
+            close(task.second_);
+            builder_.SetInsertPoint(task.first_);
+            return;
+        case Step::END_IF:
+            open(task.first_);
+            return;
+        case Step::WHILE_END:
+            loops_.pop_back();
+            open(task.first_);
+            builder_.SetInsertPoint(task.second_);
+            return;
+        case Step::OUTPUT:
+            builder_.CreateCall(print_, {operand()});
+            return;
+        }
+    }
+
+    llvm::AllocaInst* variable(VariableExpression* node) {
+        assert(node->depth_ >= 0 && static_cast<size_t>(node->depth_) < scopes_.size());
+        return scopes_[node->depth_][node->slot_];
+    }
+
+    llvm::BasicBlock* block(const char* name) {
+        return llvm::BasicBlock::Create(context_, name, main_);
+    }
+
+    // Falls through to next unless the current block already ended in
+    // break/continue; code after those lands in an unreachable block that
+    // LLVM drops.
+    void close(llvm::BasicBlock* next) {
+        if (!builder_.GetInsertBlock()->getTerminator()) {
+            builder_.CreateBr(next);
+        }
+    }
+
+    void open(llvm::BasicBlock* next) {
+        close(next);
+        builder_.SetInsertPoint(next);
+    }
+
+    llvm::Value* truth(llvm::Value* value) {
+        return builder_.CreateICmpNE(value, builder_.getInt32(0));
+    }
+
+    llvm::Value* widen(llvm::Value* flag) {
+        return builder_.CreateZExt(flag, i32_);
+    }
+
+    llvm::Constant* string(const std::string& text, const char* name) {
+        auto& global = strings_[text];
+        if (!global) {
+            global = builder_.CreateGlobalStringPtr(text, name, 0, module_.get());
+        }
+        return global;
+    }
+
+    llvm::Function* declare(const char* name, llvm::Type* result,
+                            std::vector<llvm::Type*> params, bool vararg = false) {
+        auto type = llvm::FunctionType::get(result, params, vararg);
+        return llvm::cast<llvm::Function>(module_->getOrInsertFunction(name, type).getCallee());
+    }
+
+    // paracl_fail(msg): prints to stderr and exits with status 1.
+    // paracl_print(v):  printf("%d\n", v).
+    // paracl_input():   scanf("%ld"), failing on anything but an integer
+    //                   that fits in 32 bits, like the VM's input.
+    void defineRuntime() {
+        auto i8ptr = builder_.getInt8PtrTy();
+        auto printf = declare("printf", i32_, {i8ptr}, true);
+        auto scanf = declare("scanf", i32_, {i8ptr}, true);
+        auto fputs = declare("fputs", i32_, {i8ptr, i8ptr});
+        auto fflush = declare("fflush", i32_, {i8ptr});
+        auto exit = declare("exit", builder_.getVoidTy(), {i32_});
+        auto stderrVar = module_->getOrInsertGlobal("stderr", i8ptr);
+
+        fail_ = llvm::Function::Create(llvm::FunctionType::get(builder_.getVoidTy(), {i8ptr}, false),
+                                       llvm::Function::InternalLinkage, "paracl_fail", module_.get());
+        fail_->setDoesNotReturn();
+        builder_.SetInsertPoint(llvm::BasicBlock::Create(context_, "entry", fail_));
+        builder_.CreateCall(fflush, {llvm::ConstantPointerNull::get(i8ptr)});
+        auto err = builder_.CreateLoad(i8ptr, stderrVar);
+        builder_.CreateCall(fputs, {fail_->getArg(0), err});
+        builder_.CreateCall(fputs, {string("\n", "newline"), err});
+        builder_.CreateCall(exit, {builder_.getInt32(1)});
+        builder_.CreateUnreachable();
+
+        print_ = llvm::Function::Create(llvm::FunctionType::get(builder_.getVoidTy(), {i32_}, false),
+                                        llvm::Function::InternalLinkage, "paracl_print", module_.get());
+        builder_.SetInsertPoint(llvm::BasicBlock::Create(context_, "entry", print_));
+        builder_.CreateCall(printf, {string("%d\n", "print.format"), print_->getArg(0)});
+        builder_.CreateRetVoid();
+
+        input_ = llvm::Function::Create(llvm::FunctionType::get(i32_, false),
+                                        llvm::Function::InternalLinkage, "paracl_input", module_.get());
+        builder_.SetInsertPoint(llvm::BasicBlock::Create(context_, "entry", input_));
+        auto i64 = builder_.getInt64Ty();
+        auto value = builder_.CreateAlloca(i64);
+        auto read = builder_.CreateCall(scanf, {string("%ld", "input.format"), value});
+        auto scanned = llvm::BasicBlock::Create(context_, "scanned", input_);
+        auto ok = llvm::BasicBlock::Create(context_, "ok", input_);
+        auto bad = llvm::BasicBlock::Create(context_, "bad", input_);
+        builder_.CreateCondBr(builder_.CreateICmpEQ(read, builder_.getInt32(1)), scanned, bad);
+        builder_.SetInsertPoint(scanned);
+        auto wide = builder_.CreateLoad(i64, value);
+        auto narrow = builder_.CreateTrunc(wide, i32_);
+        builder_.CreateCondBr(builder_.CreateICmpEQ(builder_.CreateSExt(narrow, i64), wide), ok, bad);
+        builder_.SetInsertPoint(bad);
+        builder_.CreateCall(fail_, {string("invalid input, integer expected", "input.error")});
+        builder_.CreateUnreachable();
+        builder_.SetInsertPoint(ok);
+        builder_.CreateRet(narrow);
+    }
+
+    // Division by zero fails, a divisor of -1 never reaches sdiv/srem.
+    llvm::Value* divide(llvm::Value* left, llvm::Value* right, bool modulo, const SourceRange& loc) {
+        auto zero = block("div.zero");
+        auto nonzero = block("div.ok");
+        builder_.CreateCondBr(builder_.CreateICmpEQ(right, builder_.getInt32(0)), zero, nonzero);
+        builder_.SetInsertPoint(zero);
+        LineIndex::Position pos = lines_.position(loc.begin);
+        std::string where = std::to_string(pos.line_) + "." + std::to_string(pos.column_);
+        builder_.CreateCall(fail_, {string(where + " error: division by zero", "div.error")});
+        builder_.CreateUnreachable();
+        builder_.SetInsertPoint(nonzero);
+
+        auto minusOne = builder_.CreateICmpEQ(right, builder_.getInt32(-1));
+        auto divisor = builder_.CreateSelect(minusOne, builder_.getInt32(1), right);
+        if (modulo) {
+            return builder_.CreateSelect(minusOne, builder_.getInt32(0), builder_.CreateSRem(left, divisor));
+        }
+        return builder_.CreateSelect(minusOne, builder_.CreateNeg(left), builder_.CreateSDiv(left, divisor));
+    }
+
+    llvm::Value* arithmetic(BinaryOperation op, llvm::Value* left, llvm::Value* right, const SourceRange& loc) {
+        switch (op) {
+        case BinaryOperation::BIN_MUL: return builder_.CreateMul(left, right);
+        case BinaryOperation::BIN_DIV: return divide(left, right, false, loc);
+        case BinaryOperation::BIN_MOD: return divide(left, right, true, loc);
+        case BinaryOperation::BIN_ADD: return builder_.CreateAdd(left, right);
+        case BinaryOperation::BIN_SUB: return builder_.CreateSub(left, right);
+        case BinaryOperation::BIN_L: return widen(builder_.CreateICmpSLT(left, right));
+        case BinaryOperation::BIN_G: return widen(builder_.CreateICmpSGT(left, right));
+        case BinaryOperation::BIN_LE: return widen(builder_.CreateICmpSLE(left, right));
+        case BinaryOperation::BIN_GE: return widen(builder_.CreateICmpSGE(left, right));
+        case BinaryOperation::BIN_EQ: return widen(builder_.CreateICmpEQ(left, right));
+        case BinaryOperation::BIN_NE: return widen(builder_.CreateICmpNE(left, right));
+        default:
+            throw std::runtime_error("Unknown binary operation");
+        }
+    }
+
+    void unary(UnaryExpression* node, llvm::Value* value) {
+        switch (node->op_) {
+        case UnaryOperation::UN_ADD:
+            result(value);
+            return;
+        case UnaryOperation::UN_SUB:
+            result(builder_.CreateNeg(value));
+            return;
+        case UnaryOperation::UN_NOT:
+            result(widen(builder_.CreateICmpEQ(value, builder_.getInt32(0))));
+            return;
+        case UnaryOperation::UN_PREFIX_INC:
+        case UnaryOperation::UN_PREFIX_DEC:
+        case UnaryOperation::UN_POSTFIX_INC:
+        case UnaryOperation::UN_POSTFIX_DEC: {
+            auto var = variable(static_cast<VariableExpression*>(node->expr_));
+            bool inc = node->op_ == UnaryOperation::UN_PREFIX_INC || node->op_ == UnaryOperation::UN_POSTFIX_INC;
+            bool prefix = node->op_ == UnaryOperation::UN_PREFIX_INC || node->op_ == UnaryOperation::UN_PREFIX_DEC;
+            auto updated = inc ? builder_.CreateAdd(value, builder_.getInt32(1))
+                               : builder_.CreateSub(value, builder_.getInt32(1));
+            builder_.CreateStore(updated, var);
+            result(prefix ? updated : value);
+            return;
+        }
+        }
+    }
+
+public:
+    NodeIRGenerator(llvm::LLVMContext& context, const std::string& name, const Interner& names,
+                    const LineIndex& lines)
+    : context_(context), names_(names), lines_(lines), module_(std::make_unique<llvm::Module>(name, context)),
+      builder_(context), allocas_(context) {
+        i32_ = builder_.getInt32Ty();
+    }
+
+    std::unique_ptr<llvm::Module> generate(INode* root) {
+        defineRuntime();
+        main_ = llvm::Function::Create(llvm::FunctionType::get(i32_, false),
+                                       llvm::Function::ExternalLinkage, "main", module_.get());
+        auto entry = block("entry");
+        allocas_.SetInsertPoint(entry);
+        builder_.SetInsertPoint(block("body"));
+        if (root) {
+            run(Step::STATEMENT, root);
+        }
+        auto fflush = declare("fflush", i32_, {builder_.getInt8PtrTy()});
+        builder_.CreateCall(fflush, {llvm::ConstantPointerNull::get(builder_.getInt8PtrTy())});
+        builder_.CreateRet(builder_.getInt32(0));
+        allocas_.CreateBr(&*std::next(main_->begin()));
+
+        std::string error;
+        llvm::raw_string_ostream os{error};
+        if (llvm::verifyModule(*module_, &os)) {
+            throw std::runtime_error("invalid LLVM IR: " + os.str());
+        }
+        return std::move(module_);
+    }
+
+protected:
+    void visit(UnaryExpression* node) override {
+        push(Step::UNARY, node);
+        push(Step::EXPRESSION, node->expr_);
+    }
+
+    void visit(BinaryExpression* node) override {
+        switch (node->op_) {
+        case BinaryOperation::BIN_ASSIGN:
+            push(Step::ASSIGN, node);
+            push(Step::EXPRESSION, node->right_);
+            return;
+        case BinaryOperation::BIN_COMMA:
+            push(Step::EXPRESSION, node->right_);
+            push(Step::DISCARD, node);
+            push(Step::EXPRESSION, node->left_);
+            return;
+        case BinaryOperation::BIN_AND:
+        case BinaryOperation::BIN_OR:
+            push(Step::LOGIC_LEFT, node);
+            push(Step::EXPRESSION, node->left_);
+            return;
+        default:
+            push(Step::ARITHMETIC, node);
+            push(Step::EXPRESSION, node->right_);
+            push(Step::EXPRESSION, node->left_);
+            return;
+        }
+    }
+
+    void visit(TernaryExpression* node) override {
+        push(Step::TERNARY_CONDITION, node);
+        push(Step::EXPRESSION, node->condition_);
+    }
+
+    void visit(ConstantExpression* node) override {
+        result(builder_.getInt32(node->value_));
+    }
+
+    void visit(VariableExpression* node) override {
+        result(builder_.CreateLoad(i32_, variable(node), names_.name(node->name_)));
+    }
+
+    void visit(InputExpression* ) override {
+        result(builder_.CreateCall(input_));
+    }
+
+    void visit(BlockStatement* node) override {
+        // Zero-initialized like the VM frame, stored once on function entry.
+        std::vector<llvm::AllocaInst*> vars;
+        vars.resize(node->table_.size());
+        for (const auto& [name, decl]: node->table_) {
+            auto var = allocas_.CreateAlloca(i32_, nullptr, names_.name(name));
+            allocas_.CreateStore(allocas_.getInt32(0), var);
+            vars[decl->slot_] = var;
+        }
+        scopes_.push_back(std::move(vars));
+        push(Step::BLOCK_END, node);
+        for (auto it = node->statements_.rbegin(); it != node->statements_.rend(); ++it) {
+            push(Step::STATEMENT, *it);
+        }
+    }
+
+    void visit(ExpressionStatement* node) override {
+        push(Step::DISCARD, node);
+        push(Step::EXPRESSION, node->expr_);
+    }
+
+    void visit(IfStatement* node) override {
+        auto then = block("if.then");
+        auto end = block("if.end");
+        push(Step::END_IF, node, end);
+        push(Step::STATEMENT, node->trueBlock_);
+        push(Step::BRANCH, node, then, end);
+        push(Step::EXPRESSION, node->condition_);
+    }
+
+    void visit(IfElseStatement* node) override {
+        auto then = block("if.then");
+        auto otherwise = block("if.else");
+        auto end = block("if.end");
+        push(Step::END_IF, node, end);
+        push(Step::STATEMENT, node->falseBlock_);
+        push(Step::ELSE, node, otherwise, end);
+        push(Step::STATEMENT, node->trueBlock_);
+        push(Step::BRANCH, node, then, otherwise);
+        push(Step::EXPRESSION, node->condition_);
+    }
+
+    void visit(WhileStatement* node) override {
+        auto cond = block("while.cond");
+        auto body = block("while.body");
+        auto end = block("while.end");
+        open(cond);
+        loops_.push_back(Loop{cond, end});
+        push(Step::WHILE_END, node, cond, end);
+        push(Step::STATEMENT, node->block_);
+        push(Step::BRANCH, node, body, end);
+        push(Step::EXPRESSION, node->condition_);
+    }
+
+    void visit(OutputStatement* node) override {
+        push(Step::OUTPUT, node);
+        push(Step::EXPRESSION, node->expr_);
+    }
+
+    void visit(BreakStatement* ) override {
+        assert(!loops_.empty());
+        builder_.CreateBr(loops_.back().break_);
+        builder_.SetInsertPoint(block("after.break"));
+    }
+
+    void visit(ContinueStatement* ) override {
+        assert(!loops_.empty());
+        builder_.CreateBr(loops_.back().continue_);
+        builder_.SetInsertPoint(block("after.continue"));
+    }
+};
+
+} // namespace paracl::frontend
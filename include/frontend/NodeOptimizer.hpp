@@ -0,0 +1,500 @@
+#pragma once
+
+#include <deque>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <cassert>
+
+#include "AST.hpp"
+#include "NodeVisitor.hpp"
+#include "backend/Arithmetic.hpp"
+
+namespace paracl::frontend
+{
+
+// Constant folding, algebraic identities and dead branch pruning over an
+// analyzed AST. Expressions whose value is dropped are only removed when
+// they are pure: no input, no assignment, no ++/--, and no division that
+// may trap at run time.
+//
+// Children are always folded before their parent, so the pass is a
+// post-order walk: the results of finished subtrees wait on a stack until
+// their parent takes them.
+class NodeOptimizer : public NodeVisitor
+{
+private:
+    using NodeVisitor::postOrder;
+    using NodeVisitor::visit;
+
+    // A folded expression, or a simplified statement, nullptr if it was
+    // removed.
+    struct Folded
+    {
+        INode* node_;
+        bool pure_;
+    };
+
+    AST& tree_;
+    std::vector<Folded> results_;
+    size_t removed_ = 0;
+
+    size_t countNodes(INode* root) {
+        size_t count = 0;
+        for (INode* node: postOrder(root)) {
+            (void)node;
+            ++count;
+        }
+        return count;
+    }
+
+    Expression* fold(bool& pure) {
+        Folded folded = results_.back();
+        results_.pop_back();
+        pure = folded.pure_;
+        return static_cast<Expression*>(folded.node_);
+    }
+
+    Statement* simplify() {
+        Folded folded = results_.back();
+        results_.pop_back();
+        return static_cast<Statement*>(folded.node_);
+    }
+
+    // Statement slots that can not be empty get an empty block instead.
+    Statement* orEmpty(Statement* stat, const SourceRange& loc) {
+        return stat ? stat : tree_.createNode<BlockStatement>(loc);
+    }
+
+    void result(Expression* expr, bool pure) {
+        results_.push_back(Folded{expr, pure});
+    }
+
+    void result(Statement* stat) {
+        results_.push_back(Folded{stat, false});
+    }
+
+    void constant(const SourceRange& loc, int value) {
+        result(tree_.createNode<ConstantExpression>(loc, value), true);
+    }
+
+    static std::optional<int> value(Expression* expr) {
+        if (isa<ConstantExpression>(expr)) {
+            return static_cast<ConstantExpression*>(expr)->value_;
+        }
+        return std::nullopt;
+    }
+
+    // Expressions that can only evaluate to 0 or 1.
+    static bool isBoolean(Expression* expr) {
+        if (auto val = value(expr)) {
+            return *val == 0 || *val == 1;
+        }
+        if (isa<UnaryExpression>(expr)) {
+            return static_cast<UnaryExpression*>(expr)->op_ == UnaryOperation::UN_NOT;
+        }
+        if (isa<BinaryExpression>(expr)) {
+            switch (static_cast<BinaryExpression*>(expr)->op_) {
+            case BinaryOperation::BIN_L:
+            case BinaryOperation::BIN_G:
+            case BinaryOperation::BIN_LE:
+            case BinaryOperation::BIN_GE:
+            case BinaryOperation::BIN_EQ:
+            case BinaryOperation::BIN_NE:
+            case BinaryOperation::BIN_AND:
+            case BinaryOperation::BIN_OR:
+                return true;
+            default:
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // Compares the two trees node by node with a stack of pairs still to
+    // check; nodes of the same kind have the same children.
+    static bool equal(Expression* lhs, Expression* rhs) {
+        std::vector<std::pair<INode*, INode*>> pending{{lhs, rhs}};
+        while (!pending.empty()) {
+            auto [l, r] = pending.back();
+            pending.pop_back();
+            if (l->kind_ != r->kind_) {
+                return false;
+            }
+            switch (l->kind_) {
+            case NodeKind::UNARY_EXPRESSION:
+                if (static_cast<UnaryExpression*>(l)->op_ != static_cast<UnaryExpression*>(r)->op_) {
+                    return false;
+                }
+                break;
+            case NodeKind::BINARY_EXPRESSION:
+                if (static_cast<BinaryExpression*>(l)->op_ != static_cast<BinaryExpression*>(r)->op_) {
+                    return false;
+                }
+                break;
+            case NodeKind::TERNARY_EXPRESSION:
+                break;
+            case NodeKind::CONSTANT_EXPRESSION:
+                if (static_cast<ConstantExpression*>(l)->value_ != static_cast<ConstantExpression*>(r)->value_) {
+                    return false;
+                }
+                break;
+            case NodeKind::VARIABLE_EXPRESSION: {
+                auto lv = static_cast<VariableExpression*>(l);
+                auto rv = static_cast<VariableExpression*>(r);
+                if (lv->depth_ != rv->depth_ || lv->slot_ != rv->slot_ || lv->name_ != rv->name_) {
+                    return false;
+                }
+                break;
+            }
+            default:
+                return false;
+            }
+            for (size_t i = 0; INode* child = childAt(l, i); ++i) {
+                pending.emplace_back(child, childAt(r, i));
+            }
+        }
+        return true;
+    }
+
+    static std::optional<int> evaluate(BinaryOperation op, int lhs, int rhs) {
+        using namespace backend;
+        switch (op) {
+        case BinaryOperation::BIN_MUL:
+            return wrap(int64_t{lhs} * rhs);
+        case BinaryOperation::BIN_DIV:
+            return rhs ? std::optional<int>{divide(lhs, rhs)} : std::nullopt;
+        case BinaryOperation::BIN_MOD:
+            return rhs ? std::optional<int>{modulo(lhs, rhs)} : std::nullopt;
+        case BinaryOperation::BIN_ADD:
+            return wrap(int64_t{lhs} + rhs);
+        case BinaryOperation::BIN_SUB:
+            return wrap(int64_t{lhs} - rhs);
+        case BinaryOperation::BIN_L:
+            return lhs < rhs;
+        case BinaryOperation::BIN_G:
+            return lhs > rhs;
+        case BinaryOperation::BIN_LE:
+            return lhs <= rhs;
+        case BinaryOperation::BIN_GE:
+            return lhs >= rhs;
+        case BinaryOperation::BIN_EQ:
+            return lhs == rhs;
+        case BinaryOperation::BIN_NE:
+            return lhs != rhs;
+        case BinaryOperation::BIN_AND:
+            return lhs && rhs;
+        case BinaryOperation::BIN_OR:
+            return lhs || rhs;
+        case BinaryOperation::BIN_COMMA:
+            return rhs;
+        default:
+            return std::nullopt;
+        }
+    }
+
+public:
+    NodeOptimizer(AST& tree)
+    : tree_(tree) {}
+
+    // Returns the simplified root, nullptr if the whole tree was removed.
+    INode* optimize(INode* root) {
+        removed_ = 0;
+        if (!root) {
+            return nullptr;
+        }
+        size_t before = countNodes(root);
+        for (INode* node: postOrder(root)) {
+            visit(node);
+        }
+        assert(results_.size() == 1);
+        INode* simplified = results_.back().node_;
+        results_.clear();
+        size_t after = simplified ? countNodes(simplified) : 0;
+        removed_ = before > after ? before - after : 0;
+        return simplified;
+    }
+
+    // How many nodes the last optimize() left unreachable.
+    size_t removed() const {
+        return removed_;
+    }
+
+protected:
+    void visit(UnaryExpression* node) override {
+        bool pure;
+        node->expr_ = fold(pure);
+        auto val = value(node->expr_);
+        switch (node->op_) {
+        case UnaryOperation::UN_ADD:
+            result(node->expr_, pure);
+            return;
+        case UnaryOperation::UN_SUB:
+            if (val) {
+                constant(node->loc_, backend::wrap(-int64_t{*val}));
+                return;
+            }
+            if (isa<UnaryExpression>(node->expr_)) {
+                auto inner = static_cast<UnaryExpression*>(node->expr_);
+                if (inner->op_ == UnaryOperation::UN_SUB) {
+                    result(inner->expr_, pure);
+                    return;
+                }
+            }
+            break;
+        case UnaryOperation::UN_NOT:
+            if (val) {
+                constant(node->loc_, !*val);
+                return;
+            }
+            if (isa<UnaryExpression>(node->expr_)) {
+                auto inner = static_cast<UnaryExpression*>(node->expr_);
+                if (inner->op_ == UnaryOperation::UN_NOT && isBoolean(inner->expr_)) {
+                    result(inner->expr_, pure);
+                    return;
+                }
+            }
+            break;
+        default:
+            pure = false;
+            break;
+        }
+        result(node, pure);
+    }
+
+    void visit(BinaryExpression* node) override {
+        bool leftPure;
+        bool rightPure;
+        Expression* right = fold(rightPure);
+        Expression* left = fold(leftPure);
+        node->right_ = right;
+        if (node->op_ == BinaryOperation::BIN_ASSIGN) {
+            // The target stays as it is.
+            result(node, false);
+            return;
+        }
+        node->left_ = left;
+        auto lhs = value(node->left_);
+        auto rhs = value(node->right_);
+        bool pure = leftPure && rightPure;
+
+        if (lhs && rhs) {
+            if (auto folded = evaluate(node->op_, *lhs, *rhs)) {
+                constant(node->loc_, *folded);
+                return;
+            }
+        }
+
+        switch (node->op_) {
+        case BinaryOperation::BIN_ADD:
+            if (rhs == 0) {
+                result(node->left_, leftPure);
+                return;
+            }
+            if (lhs == 0) {
+                result(node->right_, rightPure);
+                return;
+            }
+            break;
+        case BinaryOperation::BIN_SUB:
+            if (rhs == 0) {
+                result(node->left_, leftPure);
+                return;
+            }
+            break;
+        case BinaryOperation::BIN_MUL:
+            if (rhs == 1) {
+                result(node->left_, leftPure);
+                return;
+            }
+            if (lhs == 1) {
+                result(node->right_, rightPure);
+                return;
+            }
+            if ((rhs == 0 && leftPure) || (lhs == 0 && rightPure)) {
+                constant(node->loc_, 0);
+                return;
+            }
+            break;
+        case BinaryOperation::BIN_DIV:
+        case BinaryOperation::BIN_MOD:
+            // x / 0 must still fail at run time, x / c can not.
+            if (!rhs || *rhs == 0) {
+                pure = false;
+            } else if (*rhs == 1 && node->op_ == BinaryOperation::BIN_DIV) {
+                result(node->left_, leftPure);
+                return;
+            } else if ((*rhs == 1 || *rhs == -1) && node->op_ == BinaryOperation::BIN_MOD && leftPure) {
+                constant(node->loc_, 0);
+                return;
+            }
+            break;
+        case BinaryOperation::BIN_AND:
+            if (lhs == 0) {
+                constant(node->loc_, 0);
+                return;
+            }
+            if (lhs && isBoolean(node->right_)) {
+                result(node->right_, rightPure);
+                return;
+            }
+            if (rhs && *rhs && isBoolean(node->left_)) {
+                result(node->left_, leftPure);
+                return;
+            }
+            if (rhs == 0 && leftPure) {
+                constant(node->loc_, 0);
+                return;
+            }
+            break;
+        case BinaryOperation::BIN_OR:
+            if (lhs && *lhs) {
+                constant(node->loc_, 1);
+                return;
+            }
+            if (lhs && isBoolean(node->right_)) {
+                result(node->right_, rightPure);
+                return;
+            }
+            if (rhs == 0 && isBoolean(node->left_)) {
+                result(node->left_, leftPure);
+                return;
+            }
+            if (rhs && *rhs && leftPure) {
+                constant(node->loc_, 1);
+                return;
+            }
+            break;
+        case BinaryOperation::BIN_COMMA:
+            if (leftPure) {
+                result(node->right_, rightPure);
+                return;
+            }
+            break;
+        default:
+            break;
+        }
+        result(node, pure);
+    }
+
+    void visit(TernaryExpression* node) override {
+        bool conditionPure;
+        bool onTruePure;
+        bool onFalsePure;
+        node->onFalse_ = fold(onFalsePure);
+        node->onTrue_ = fold(onTruePure);
+        node->condition_ = fold(conditionPure);
+        if (auto cond = value(node->condition_)) {
+            if (*cond) {
+                result(node->onTrue_, onTruePure);
+            } else {
+                result(node->onFalse_, onFalsePure);
+            }
+            return;
+        }
+        if (equal(node->onTrue_, node->onFalse_)) {
+            if (conditionPure) {
+                result(node->onTrue_, onTruePure);
+            } else {
+                result(tree_.createNode<BinaryExpression>(node->loc_, BinaryOperation::BIN_COMMA,
+                    node->condition_, node->onTrue_), false);
+            }
+            return;
+        }
+        result(node, conditionPure && onTruePure && onFalsePure);
+    }
+
+    void visit(ConstantExpression* node) override {
+        result(node, true);
+    }
+
+    void visit(VariableExpression* node) override {
+        result(node, true);
+    }
+
+    void visit(InputExpression* node) override {
+        result(node, false);
+    }
+
+    void visit(BlockStatement* node) override {
+        std::deque<Statement*> statements;
+        auto first = results_.end() - static_cast<std::ptrdiff_t>(node->statements_.size());
+        for (auto it = first; it != results_.end(); ++it) {
+            auto simplified = static_cast<Statement*>(it->node_);
+            if (!simplified) {
+                continue;
+            }
+            if (isa<BlockStatement>(simplified) && static_cast<BlockStatement*>(simplified)->statements_.empty()) {
+                continue;
+            }
+            statements.push_back(simplified);
+        }
+        results_.erase(first, results_.end());
+        node->statements_ = std::move(statements);
+        result(node);
+    }
+
+    void visit(ExpressionStatement* node) override {
+        bool pure;
+        node->expr_ = fold(pure);
+        result(pure ? nullptr : node);
+    }
+
+    void visit(IfStatement* node) override {
+        bool pure;
+        Statement* trueBlock = simplify();
+        node->condition_ = fold(pure);
+        if (auto cond = value(node->condition_)) {
+            result(*cond ? trueBlock : nullptr);
+            return;
+        }
+        if (!trueBlock) {
+            result(pure ? nullptr : tree_.createNode<ExpressionStatement>(node->loc_, node->condition_));
+            return;
+        }
+        node->trueBlock_ = trueBlock;
+        result(node);
+    }
+
+    void visit(IfElseStatement* node) override {
+        bool pure;
+        Statement* falseBlock = simplify();
+        Statement* trueBlock = simplify();
+        node->condition_ = fold(pure);
+        if (auto cond = value(node->condition_)) {
+            result(*cond ? trueBlock : falseBlock);
+            return;
+        }
+        node->trueBlock_ = orEmpty(trueBlock, node->loc_);
+        node->falseBlock_ = orEmpty(falseBlock, node->loc_);
+        result(node);
+    }
+
+    void visit(WhileStatement* node) override {
+        bool pure;
+        Statement* block = simplify();
+        node->condition_ = fold(pure);
+        if (auto cond = value(node->condition_); cond == 0) {
+            result(nullptr);
+            return;
+        }
+        node->block_ = orEmpty(block, node->loc_);
+        result(node);
+    }
+
+    void visit(OutputStatement* node) override {
+        bool pure;
+        node->expr_ = fold(pure);
+        result(node);
+    }
+
+    void visit(BreakStatement* node) override {
+        result(node);
+    }
+
+    void visit(ContinueStatement* node) override {
+        result(node);
+    }
+};
+
+} // namespace paracl::frontend
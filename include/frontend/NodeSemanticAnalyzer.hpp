@@ -1,6 +1,7 @@
 #pragma once
 
 #include <vector>
+#include <cstdint>
 
 #include "NodeVisitor.hpp"
 #include "SymTable.hpp"
@@ -12,26 +13,96 @@ namespace paracl::frontend
 
 class Driver;
 
+// Runs on an explicit work stack instead of native recursion, so the depth
+// of a program is bounded by the heap. A node's visit only checks the node
+// and pushes what comes after it: its children in reverse order and the
+// steps that close scopes, loops and assignment targets once they are done.
 class NodeSemanticAnalyzer : public NodeVisitor
 {
 private:
     using NodeVisitor::visit;
 
+    enum class Step : uint8_t
+    {
+        VISIT,
+        ASSIGN,
+        END_ASSIGN,
+        END_SCOPE,
+        END_LOOP,
+    };
+
+    struct Task
+    {
+        Step step_;
+        INode* node_;
+    };
+
     Driver& driver_;
     ScopeChecker scopes_;
     std::vector<INode*> whiles_;
+    std::vector<Task> tasks_;
     bool declareMode = false;
+    // Where global declarations are copied to when the statements that
+    // make them are freed after analysis.
+    AST* globalStore_ = nullptr;
+
+    void push(INode* node) {
+        tasks_.push_back(Task{Step::VISIT, node});
+    }
+
+    void push(Step step, INode* node = nullptr) {
+        tasks_.push_back(Task{step, node});
+    }
+
+    // The right side of an assignment is analyzed, its target comes next.
+    void assign(BinaryExpression* node) {
+        declareMode = true;
+        if (!isa<VariableExpression>(node->left_)) {
+            driver_.getReporter()->reportError<UnassignableExpression>(node->loc_);
+        }
+    }
 
 public:
     NodeSemanticAnalyzer(Driver& driver)
-    : driver_(driver) {}
+    : driver_(driver), scopes_(driver.getInterner()->size()) {}
 
     void clear() {
         scopes_.clear();
     }
 
     void analyze(INode* root) {
-        visit(root);
+        tasks_.clear();
+        push(root);
+        while (!tasks_.empty()) {
+            driver_.checkInterrupt();
+            Task task = tasks_.back();
+            tasks_.pop_back();
+            switch (task.step_) {
+            case Step::VISIT:
+                visit(task.node_);
+                break;
+            case Step::ASSIGN:
+                assign(static_cast<BinaryExpression*>(task.node_));
+                break;
+            case Step::END_ASSIGN:
+                declareMode = false;
+                break;
+            case Step::END_SCOPE:
+                scopes_.endScope();
+                break;
+            case Step::END_LOOP:
+                whiles_.pop_back();
+                break;
+            }
+        }
+    }
+
+    // Opens the global scope of a streamed program. Every statement passed
+    // to analyze() afterwards is resolved in it, and the globals it
+    // declares are copied into store, so they outlive the statement.
+    void beginGlobals(BlockStatement* globals, AST& store) {
+        scopes_.beginScope(std::addressof(globals->table_));
+        globalStore_ = std::addressof(store);
     }
 
 protected:
@@ -41,43 +112,54 @@ protected:
             case UnaryOperation::UN_PREFIX_DEC:
             case UnaryOperation::UN_POSTFIX_INC:
             case UnaryOperation::UN_POSTFIX_DEC:
-                if (typeid(*node->expr_) != typeid(VariableExpression)) {
+                if (!isa<VariableExpression>(node->expr_)) {
                     driver_.getReporter()->reportError<UnassignableExpression>(node->loc_);
                 }
                 break;
             default:
                 break;
         }
-        visit(node->expr_);
+        push(node->expr_);
     }
 
+    // The right operand goes first, so `x = x + 1` does not declare x.
     void visit(BinaryExpression* node) override {
-        visit(node->right_);
         if (node->op_ == BinaryOperation::BIN_ASSIGN) {
-            declareMode = true;
-            if (typeid(*node->left_) != typeid(VariableExpression)) {
-                driver_.getReporter()->reportError<UnassignableExpression>(node->loc_);
-            }
-            visit(node->left_);
-            declareMode = false;
+            push(Step::END_ASSIGN);
+            push(node->left_);
+            push(Step::ASSIGN, node);
         } else {
-            visit(node->left_);
+            push(node->left_);
         }
+        push(node->right_);
     }
 
     void visit(TernaryExpression* node) override {
-        visit(node->condition_);
-        visit(node->onTrue_);
-        visit(node->onFalse_);
+        push(node->onFalse_);
+        push(node->onTrue_);
+        push(node->condition_);
     }
 
     void visit(ConstantExpression* ) override {}
 
     void visit(VariableExpression* node) override {
-        if (declareMode) {
-            scopes_.declare(node->name_, node);
-        } else if (!scopes_.declared(node->name_)) {
-            driver_.getReporter()->reportError<UndeclaredIdentifier>(node->loc_, node->name_);
+        auto found = scopes_.lookupDeclaration(node->name_);
+        if (found) {
+            node->depth_ = found->first;
+            node->slot_ = found->second->slot_;
+        } else if (declareMode) {
+            node->depth_ = scopes_.depth();
+            node->slot_ = static_cast<int>(scopes_.scopeSize());
+            VariableExpression* declaration = node;
+            if (globalStore_ && node->depth_ == 0) {
+                declaration = globalStore_->createNode<VariableExpression>(node->loc_, node->name_);
+                declaration->depth_ = node->depth_;
+                declaration->slot_ = node->slot_;
+            }
+            scopes_.declare(node->name_, declaration);
+        } else {
+            driver_.getReporter()->reportError<UndeclaredIdentifier>(
+                node->loc_, std::string{driver_.getInterner()->name(node->name_)});
         }
     }
 
@@ -85,36 +167,36 @@ protected:
 
     void visit(BlockStatement* node) override {
         scopes_.beginScope(std::addressof(node->table_));
-        for (auto statement: node->statements_) {
-            visit(statement);
+        push(Step::END_SCOPE);
+        for (auto it = node->statements_.rbegin(); it != node->statements_.rend(); ++it) {
+            push(*it);
         }
-        scopes_.endScope();
     }
 
     void visit(ExpressionStatement* node) override {
-        visit(node->expr_);
+        push(node->expr_);
     }
 
     void visit(IfStatement* node) override {
-        visit(node->condition_);
-        visit(node->trueBlock_);
+        push(node->trueBlock_);
+        push(node->condition_);
     }
 
     void visit(IfElseStatement* node) override {
-        visit(node->condition_);
-        visit(node->trueBlock_);
-        visit(node->falseBlock_);
+        push(node->falseBlock_);
+        push(node->trueBlock_);
+        push(node->condition_);
     }
 
     void visit(WhileStatement* node) override {
         whiles_.push_back(node);
-        visit(node->condition_);
-        visit(node->block_);
-        whiles_.pop_back();
+        push(Step::END_LOOP);
+        push(node->block_);
+        push(node->condition_);
     }
 
     void visit(OutputStatement* node) override {
-        visit(node->expr_);
+        push(node->expr_);
     }
 
     void visit(BreakStatement* node) override {
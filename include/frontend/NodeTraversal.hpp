@@ -0,0 +1,166 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+
+#include "INode.hpp"
+
+namespace paracl::frontend
+{
+
+// i-th child of a node in evaluation order, nullptr past the last one.
+inline INode* childAt(INode* node, size_t index) {
+    switch (node->kind_) {
+    case NodeKind::UNARY_EXPRESSION: {
+        auto un = static_cast<UnaryExpression*>(node);
+        return index == 0 ? un->expr_ : nullptr;
+    }
+    case NodeKind::BINARY_EXPRESSION: {
+        auto bin = static_cast<BinaryExpression*>(node);
+        return index == 0 ? bin->left_ : index == 1 ? bin->right_ : nullptr;
+    }
+    case NodeKind::TERNARY_EXPRESSION: {
+        auto ter = static_cast<TernaryExpression*>(node);
+        INode* children[] = {ter->condition_, ter->onTrue_, ter->onFalse_};
+        return index < 3 ? children[index] : nullptr;
+    }
+    case NodeKind::CONSTANT_EXPRESSION:
+    case NodeKind::VARIABLE_EXPRESSION:
+    case NodeKind::INPUT_EXPRESSION:
+        return nullptr;
+    case NodeKind::BLOCK_STATEMENT: {
+        auto block = static_cast<BlockStatement*>(node);
+        return index < block->statements_.size() ? block->statements_[index] : nullptr;
+    }
+    case NodeKind::EXPRESSION_STATEMENT: {
+        auto exprStat = static_cast<ExpressionStatement*>(node);
+        return index == 0 ? exprStat->expr_ : nullptr;
+    }
+    case NodeKind::IF_STATEMENT: {
+        auto ifStat = static_cast<IfStatement*>(node);
+        INode* children[] = {ifStat->condition_, ifStat->trueBlock_};
+        return index < 2 ? children[index] : nullptr;
+    }
+    case NodeKind::IF_ELSE_STATEMENT: {
+        auto ifStat = static_cast<IfElseStatement*>(node);
+        INode* children[] = {ifStat->condition_, ifStat->trueBlock_, ifStat->falseBlock_};
+        return index < 3 ? children[index] : nullptr;
+    }
+    case NodeKind::WHILE_STATEMENT: {
+        auto whileStat = static_cast<WhileStatement*>(node);
+        INode* children[] = {whileStat->condition_, whileStat->block_};
+        return index < 2 ? children[index] : nullptr;
+    }
+    case NodeKind::OUTPUT_STATEMENT: {
+        auto out = static_cast<OutputStatement*>(node);
+        return index == 0 ? out->expr_ : nullptr;
+    }
+    case NodeKind::BREAK_STATEMENT:
+    case NodeKind::CONTINUE_STATEMENT:
+        return nullptr;
+    }
+    throw std::runtime_error("Can not cast base class");
+}
+
+// Iterative post-order walk driven by an explicit stack that only ever
+// holds the current root-to-node path, so memory is O(depth) and the
+// walk itself allocates only when the tree gets deeper than the reserve.
+class PostOrderTraversal final
+{
+private:
+    static constexpr size_t defaultDepth = 64;
+
+    struct Frame
+    {
+        INode* node_;
+        size_t next_;
+    };
+
+    std::vector<Frame> stack_;
+
+public:
+    class iterator
+    {
+    private:
+        PostOrderTraversal* walk_ = nullptr;
+        INode* current_ = nullptr;
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = INode*;
+        using difference_type = std::ptrdiff_t;
+        using pointer = INode**;
+        using reference = INode*;
+
+        iterator() = default;
+
+        iterator(PostOrderTraversal* walk)
+        : walk_(walk) {
+            ++*this;
+        }
+
+        INode* operator*() const {
+            return current_;
+        }
+
+        iterator& operator++() {
+            current_ = walk_->next();
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const {
+            return current_ == nullptr;
+        }
+    };
+
+    PostOrderTraversal(INode* root = nullptr, size_t depth = defaultDepth) {
+        stack_.reserve(depth);
+        reset(root);
+    }
+
+    void reset(INode* root) {
+        stack_.clear();
+        if (root) {
+            stack_.push_back(Frame{root, 0});
+        }
+    }
+
+    // Next node in post-order, nullptr once the walk is over.
+    INode* next() {
+        while (!stack_.empty()) {
+            Frame& top = stack_.back();
+            INode* child = childAt(top.node_, top.next_++);
+            if (child) {
+                stack_.push_back(Frame{child, 0});
+                continue;
+            }
+            INode* node = top.node_;
+            stack_.pop_back();
+            return node;
+        }
+        return nullptr;
+    }
+
+    // Appends every remaining node to a caller-supplied buffer.
+    void fill(std::vector<INode*>& nodes) {
+        while (INode* node = next()) {
+            nodes.push_back(node);
+        }
+    }
+
+    iterator begin() {
+        return iterator{this};
+    }
+
+    std::default_sentinel_t end() const {
+        return std::default_sentinel;
+    }
+};
+
+} // namespace paracl::frontend
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <istream>
+
+#include "parser.tab.hh"
+#include "Location.hpp"
+#include "SourceBuffer.hpp"
+
+namespace paracl::frontend
+{
+
+class Driver;
+
+// Hand-written scanner for the tokens of Lexer.l. Characters are
+// classified through a 256-entry table, whitespace and comments are
+// skipped a SIMD block at a time, keywords are found with a perfect hash
+// and constants are parsed inline. Stands in for the Flex scanner when
+// built with -DPARACL_HAND_LEXER=ON.
+class Scanner
+{
+private:
+    Driver& driver_;
+    LineIndex& lines_;
+    // Null unless the program is read from a stream.
+    std::istream* in_ = nullptr;
+    std::string buffer_;
+    bool eof_ = false;
+    // Program text scanned so far, always followed by a NUL at end_.
+    const char* text_;
+    size_t end_;
+    size_t pos_ = 0;
+    // Offset of text_[0] in the program: a stream's buffer drops the text
+    // it has scanned.
+    uint32_t base_ = 0;
+
+    // Appends what the stream has buffered, waiting for at most one
+    // character. False at the end of the program.
+    bool more();
+
+    // Drops the scanned text of a stream.
+    void compact();
+
+    char peek(size_t pos) {
+        if (pos == end_) {
+            more();
+        }
+        return text_[pos];
+    }
+
+    SourceRange range(size_t begin, size_t end) const {
+        return SourceRange{base_ + static_cast<uint32_t>(begin), base_ + static_cast<uint32_t>(end)};
+    }
+
+    void newLines(size_t pos, uint32_t mask);
+
+    size_t skipSpace(size_t pos);
+
+    // Skips a `//` comment up to the line break.
+    size_t skipLine(size_t pos);
+
+    // Skips a `/* */` comment starting at pos, false if it is not closed.
+    bool skipComment(size_t& pos);
+
+    Parser::symbol_type identifier(size_t begin);
+
+    Parser::symbol_type constant(size_t begin);
+
+public:
+    Scanner(Driver& driver, LineIndex& lines, SourceBuffer& source);
+
+    Scanner(Driver& driver, LineIndex& lines, std::istream& in);
+
+    Scanner(const Scanner&) = delete;
+    Scanner& operator=(const Scanner&) = delete;
+
+    Parser::symbol_type getNextToken();
+
+    // True when program text has been read but not scanned yet.
+    bool pending();
+};
+
+} // namespace paracl::frontend
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <cstddef>
+#include <istream>
+#include <string_view>
+
+namespace paracl::frontend
+{
+
+// Program text followed by the two NUL bytes the scanner expects past the
+// end of a buffer it works on in place. Files are mapped privately and
+// writable: the scanner NUL-terminates tokens inside the buffer, the file
+// itself is never touched.
+class SourceBuffer final
+{
+private:
+    char* data_ = nullptr;
+    size_t size_ = 0;
+    size_t mapped_ = 0;
+    std::string text_;
+
+public:
+    // Maps the file at path. Throws std::runtime_error.
+    explicit SourceBuffer(const std::string& path);
+
+    // Reads the whole stream into memory, for stdin and generated programs.
+    explicit SourceBuffer(std::istream& in);
+
+    SourceBuffer(const SourceBuffer&) = delete;
+    SourceBuffer& operator=(const SourceBuffer&) = delete;
+
+    ~SourceBuffer();
+
+    char* data() {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    std::string_view view() const {
+        return std::string_view{data_, size_};
+    }
+};
+
+} // namespace paracl::frontend
@@ -0,0 +1,230 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <ctime>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <algorithm>
+
+#include "INode.hpp"
+#include "NodeTraversal.hpp"
+#include "backend/ByteCode.hpp"
+
+namespace paracl::frontend
+{
+
+// Compiler and runtime counters behind --stats. When disabled, timers do
+// not read clocks and tokens and tree nodes are never counted; the only
+// remaining cost is one enabled() test per token.
+class Statistics final
+{
+private:
+    static constexpr size_t kindCount = static_cast<size_t>(NodeKind::CONTINUE_STATEMENT) + 1;
+
+    struct Phase
+    {
+        std::string name_;
+        double wall_ = 0;
+        double cpu_ = 0;
+    };
+
+    bool enabled_ = false;
+    std::vector<Phase> phases_;
+
+    size_t tokens_ = 0;
+    std::array<size_t, kindCount> nodes_{};
+    size_t scopes_ = 0;
+    size_t symbols_ = 0;
+    size_t largestScope_ = 0;
+    size_t removed_ = 0;
+
+    size_t instructions_ = 0;
+    uint32_t frameSize_ = 0;
+    uint64_t executed_ = 0;
+    // Instructions are counted only by the interpreter; the JIT, which
+    // --stats leaves on so that the timed run is the real one, does not.
+    bool counted_ = false;
+
+    // A phase timed more than once accumulates.
+    void record(const char* name, double wall, double cpu) {
+        for (auto& phase: phases_) {
+            if (phase.name_ == name) {
+                phase.wall_ += wall;
+                phase.cpu_ += cpu;
+                return;
+            }
+        }
+        phases_.push_back(Phase{name, wall, cpu});
+    }
+
+    static const char* kindName(NodeKind kind) {
+        switch (kind) {
+        case NodeKind::UNARY_EXPRESSION: return "unary";
+        case NodeKind::BINARY_EXPRESSION: return "binary";
+        case NodeKind::TERNARY_EXPRESSION: return "ternary";
+        case NodeKind::CONSTANT_EXPRESSION: return "constant";
+        case NodeKind::VARIABLE_EXPRESSION: return "variable";
+        case NodeKind::INPUT_EXPRESSION: return "input";
+        case NodeKind::BLOCK_STATEMENT: return "block";
+        case NodeKind::EXPRESSION_STATEMENT: return "expression";
+        case NodeKind::IF_STATEMENT: return "if";
+        case NodeKind::IF_ELSE_STATEMENT: return "if-else";
+        case NodeKind::WHILE_STATEMENT: return "while";
+        case NodeKind::OUTPUT_STATEMENT: return "print";
+        case NodeKind::BREAK_STATEMENT: return "break";
+        case NodeKind::CONTINUE_STATEMENT: return "continue";
+        }
+        return "unknown";
+    }
+
+public:
+    class Timer
+    {
+    private:
+        Statistics* stats_;
+        const char* name_;
+        std::chrono::steady_clock::time_point wallStart_;
+        std::clock_t cpuStart_ = 0;
+
+    public:
+        Timer(Statistics* stats, const char* name)
+        : stats_(stats), name_(name) {
+            if (stats_) {
+                wallStart_ = std::chrono::steady_clock::now();
+                cpuStart_ = std::clock();
+            }
+        }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        ~Timer() {
+            if (stats_) {
+                std::chrono::duration<double> wall = std::chrono::steady_clock::now() - wallStart_;
+                double cpu = static_cast<double>(std::clock() - cpuStart_) / CLOCKS_PER_SEC;
+                stats_->record(name_, wall.count(), cpu);
+            }
+        }
+    };
+
+    void enable() {
+        enabled_ = true;
+    }
+
+    bool enabled() const {
+        return enabled_;
+    }
+
+    // Wall and CPU time of a whole phase, a no-op when disabled.
+    Timer time(const char* phase) {
+        return Timer{enabled_ ? this : nullptr, phase};
+    }
+
+    void countToken() {
+        ++tokens_;
+    }
+
+    // Node counts by kind and symbol-table sizes of an analyzed tree.
+    void collectTree(INode* root) {
+        if (!enabled_) {
+            return;
+        }
+        nodes_.fill(0);
+        scopes_ = symbols_ = largestScope_ = 0;
+        for (INode* node: PostOrderTraversal{root}) {
+            ++nodes_[static_cast<size_t>(node->kind_)];
+            if (isa<BlockStatement>(node)) {
+                auto block = static_cast<BlockStatement*>(node);
+                ++scopes_;
+                symbols_ += block->table_.size();
+                largestScope_ = std::max(largestScope_, block->table_.size());
+            }
+        }
+    }
+
+    void setRemoved(size_t removed) {
+        removed_ = removed;
+    }
+
+    void collectProgram(const backend::ProgramView& program) {
+        instructions_ = program.size_;
+        frameSize_ = program.frameSize_;
+    }
+
+    void setExecuted(uint64_t executed) {
+        executed_ = executed;
+        counted_ = true;
+    }
+
+    void report(std::ostream& os) const {
+        auto flags = os.flags();
+        os << std::fixed << std::setprecision(3);
+        os << "phase            wall ms      cpu ms\n";
+        for (const auto& phase: phases_) {
+            os << std::left << std::setw(12) << phase.name_ << std::right
+               << std::setw(12) << phase.wall_ * 1e3
+               << std::setw(12) << phase.cpu_ * 1e3 << "\n";
+        }
+        os << "tokens        " << tokens_ << "\n";
+        size_t total = 0;
+        for (auto count: nodes_) {
+            total += count;
+        }
+        os << "nodes         " << total << "\n";
+        for (size_t i = 0; i < kindCount; ++i) {
+            if (nodes_[i]) {
+                os << "  " << std::left << std::setw(12) << kindName(static_cast<NodeKind>(i))
+                   << std::right << nodes_[i] << "\n";
+            }
+        }
+        os << "scopes        " << scopes_ << "\n";
+        os << "symbols       " << symbols_ << " (largest scope " << largestScope_ << ")\n";
+        os << "removed       " << removed_ << " nodes\n";
+        os << "instructions  " << instructions_ << " (frame " << frameSize_ << " slots)\n";
+        if (counted_) {
+            os << "executed      " << executed_ << std::endl;
+        } else {
+            os << "executed      - (not counted with the JIT on, see --no-jit)" << std::endl;
+        }
+        os.flags(flags);
+    }
+
+    void reportJson(std::ostream& os) const {
+        auto flags = os.flags();
+        os << std::setprecision(9);
+        os << "{\"phases\": {";
+        for (size_t i = 0; i < phases_.size(); ++i) {
+            const Phase& phase = phases_[i];
+            os << (i ? ", " : "") << "\"" << phase.name_ << "\": {\"wall_s\": " << phase.wall_
+               << ", \"cpu_s\": " << phase.cpu_ << "}";
+        }
+        os << "}, \"tokens\": " << tokens_ << ", \"nodes\": {";
+        bool first = true;
+        for (size_t i = 0; i < kindCount; ++i) {
+            if (nodes_[i]) {
+                os << (first ? "" : ", ") << "\"" << kindName(static_cast<NodeKind>(i)) << "\": " << nodes_[i];
+                first = false;
+            }
+        }
+        os << "}, \"scopes\": " << scopes_
+           << ", \"symbols\": " << symbols_
+           << ", \"largest_scope\": " << largestScope_
+           << ", \"removed_nodes\": " << removed_
+           << ", \"instructions\": " << instructions_
+           << ", \"frame_size\": " << frameSize_
+           << ", \"executed\": ";
+        if (counted_) {
+            os << executed_;
+        } else {
+            os << "null";
+        }
+        os << "}" << std::endl;
+        os.flags(flags);
+    }
+};
+
+} // namespace paracl::frontend
@@ -1,10 +1,14 @@
 #pragma once
 
+#include <vector>
+#include <memory>
+#include <utility>
 #include <iostream>
 #include <optional>
-#include <string_view>
 #include <unordered_map>
 
+#include "Interner.hpp"
+
 namespace paracl::frontend
 {
 
@@ -13,36 +17,22 @@ struct VariableExpression;
 class SymTable final
 {
 private:
-    struct keyHash
-    {
-        std::size_t operator()(const std::string_view& key) const {
-            return std::hash<std::string_view>()(key);
-        }
-    };
-
-    struct keyEqual
-    {
-        bool operator()(const std::string_view& lhs, const std::string_view& rhs) const {
-            return lhs == rhs;
-        }
-    };
-
-    using Map = std::unordered_map<std::string_view, VariableExpression*, keyHash, keyEqual>;
+    using Map = std::unordered_map<SymbolId, VariableExpression*>;
 
     Map table_;
 
 public:
     SymTable() = default;
 
-    void declare(std::string_view name, VariableExpression* node) {
+    void declare(SymbolId name, VariableExpression* node) {
         table_.emplace(name, node);
     }
 
-    bool declared(std::string_view name) const {
+    bool declared(SymbolId name) const {
         return table_.count(name);
     }
 
-    std::optional<VariableExpression*> lookupVariable(std::string_view name) const {
+    std::optional<VariableExpression*> lookupVariable(SymbolId name) const {
         auto found = table_.find(name);
         if (found == table_.end()) {
             return std::nullopt;
@@ -67,57 +57,97 @@ public:
     }
 };
 
+// Scoped name resolution in O(1): every name has a stack of its visible
+// declarations, indexed by SymbolId, and every open scope remembers which
+// names it pushed so that leaving it pops exactly those.
 class ScopeChecker final
 {
 private:
-    std::vector<SymTable*> scopes_;
+    struct Declaration
+    {
+        int depth_;
+        VariableExpression* node_;
+    };
+
+    struct Scope
+    {
+        SymTable* table_;
+        size_t pushed_;
+    };
+
+    std::vector<std::vector<Declaration>> visible_;
+    // Names declared by the open scopes, innermost scope last.
+    std::vector<SymbolId> pushed_;
+    std::vector<Scope> scopes_;
+
+    const Declaration* innermost(SymbolId name) const {
+        if (name >= visible_.size() || visible_[name].empty()) {
+            return nullptr;
+        }
+        return std::addressof(visible_[name].back());
+    }
 
 public:
-    ScopeChecker() = default;
+    // symbols is the number of distinct names, e.g. Interner::size().
+    explicit ScopeChecker(size_t symbols = 0)
+    : visible_(symbols) {}
 
     void beginScope(SymTable* table) {
-        scopes_.push_back(table);
+        scopes_.push_back(Scope{table, pushed_.size()});
     }
 
     void endScope() {
+        size_t first = scopes_.back().pushed_;
+        for (size_t i = first; i < pushed_.size(); ++i) {
+            visible_[pushed_[i]].pop_back();
+        }
+        pushed_.resize(first);
         scopes_.pop_back();
     }
 
-    std::optional<SymTable*> lookupScope(std::string_view name) const {
-        for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
-            if ((*it)->declared(name)) {
-                return *it;
-            }
+    std::optional<SymTable*> lookupScope(SymbolId name) const {
+        if (auto decl = innermost(name)) {
+            return scopes_[decl->depth_].table_;
         }
         return std::nullopt;
     }
 
-    void declare(std::string_view name, VariableExpression* node) {
-        if (!scopes_.empty()) {
-            scopes_.back()->declare(name, node);
+    void declare(SymbolId name, VariableExpression* node) {
+        if (scopes_.empty() || scopes_.back().table_->declared(name)) {
+            return;
         }
+        scopes_.back().table_->declare(name, node);
+        if (name >= visible_.size()) {
+            visible_.resize(name + 1);
+        }
+        visible_[name].push_back(Declaration{depth(), node});
+        pushed_.push_back(name);
     }
 
-    bool declared(std::string_view name) const {
-        return lookupScope(name) != std::nullopt;
-    }
-
-    std::optional<VariableExpression*> lookupVariable(std::string_view name) const {
-        for (auto it = scopes_.rbegin(); it != scopes_.rend(); ++it) {
-            auto found = (*it)->lookupVariable(name);
-            if (found) {
-                return found;
-            }
+    std::optional<std::pair<int, VariableExpression*>> lookupDeclaration(SymbolId name) const {
+        if (auto decl = innermost(name)) {
+            return std::make_pair(decl->depth_, decl->node_);
         }
         return std::nullopt;
     }
 
-    auto begin() const {
-        return scopes_.rbegin();
+    int depth() const {
+        return static_cast<int>(scopes_.size()) - 1;
     }
 
-    auto end() const {
-        return scopes_.rend();
+    size_t scopeSize() const {
+        return scopes_.empty() ? 0 : scopes_.back().table_->size();
+    }
+
+    bool declared(SymbolId name) const {
+        return innermost(name) != nullptr;
+    }
+
+    std::optional<VariableExpression*> lookupVariable(SymbolId name) const {
+        if (auto decl = innermost(name)) {
+            return decl->node_;
+        }
+        return std::nullopt;
     }
 
     size_t size() const {
@@ -125,6 +155,10 @@ public:
     }
 
     void clear() {
+        for (auto& decls: visible_) {
+            decls.clear();
+        }
+        pushed_.clear();
         scopes_.clear();
     }
 };
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <map>
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string_view>
+#include <unordered_map>
+#include <condition_variable>
+
+#include "backend/ByteCode.hpp"
+
+namespace paracl::server
+{
+
+// `paracl --serve` protocol on a Unix stream socket, integers in host byte
+// order. The client sends one request per connection:
+//
+//   "PCL1" u32 program-size u32 input-size  program text  input
+//
+// and reads frames `u8 kind, u32 size, payload` until the connection is
+// closed: 'O' program output as it is flushed, 'E' diagnostics and, last,
+// 'S' with the i32 exit status.
+
+struct Limits
+{
+    // Bounds compiling and running the program.
+    std::chrono::milliseconds time_{5000};
+    // Bounds the request (program text and input) and the compiled
+    // program's frame and code.
+    size_t memory_ = size_t{64} << 20;
+};
+
+struct ServerOptions
+{
+    std::string socketPath_;
+    size_t workers_ = std::thread::hardware_concurrency();
+    size_t cacheSize_ = 256;
+    Limits limits_;
+    bool optimize_ = true;
+    bool jit_ = true;
+};
+
+// Compiled programs by source text, least recently used dropped first.
+class ProgramCache final
+{
+private:
+    using Entry = std::pair<std::string, std::shared_ptr<const backend::Program>>;
+
+    std::mutex mutex_;
+    size_t capacity_;
+    std::list<Entry> entries_;
+    // Keys point into entries_.
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;
+
+public:
+    explicit ProgramCache(size_t capacity)
+    : capacity_(capacity) {}
+
+    std::shared_ptr<const backend::Program> find(const std::string& source);
+
+    void insert(const std::string& source, std::shared_ptr<const backend::Program> program);
+};
+
+// One thread that sets the flag of every run past its deadline.
+class Watchdog final
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+private:
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::multimap<Clock::time_point, std::atomic<bool>*> deadlines_;
+    bool stop_ = false;
+    std::thread thread_;
+
+    void watch();
+
+public:
+    Watchdog()
+    : thread_([this] { watch(); }) {}
+
+    Watchdog(const Watchdog&) = delete;
+    Watchdog& operator=(const Watchdog&) = delete;
+
+    ~Watchdog();
+
+    void arm(Clock::time_point deadline, std::atomic<bool>* flag);
+
+    // Does nothing when the flag has already been set.
+    void disarm(Clock::time_point deadline, std::atomic<bool>* flag);
+};
+
+class Server final
+{
+private:
+    ServerOptions options_;
+    ProgramCache cache_;
+    Watchdog watchdog_;
+
+    // Null after writing the diagnostics of a program that does not compile.
+    // Parsing and analysis stop once interrupt is set.
+    std::shared_ptr<const backend::Program> compile(const std::string& source, std::ostream& diagnostics,
+                                                    const std::atomic<bool>* interrupt);
+
+    void execute(const backend::Program& program, const std::string& input, int fd,
+                 const std::atomic<bool>* interrupt);
+
+    // Answers one connection and closes it.
+    void serve(int fd);
+
+public:
+    explicit Server(const ServerOptions& options)
+    : options_(options), cache_(options.cacheSize_) {}
+
+    // Accepts connections until the process is killed. Throws
+    // std::runtime_error when the socket can not be set up.
+    void run();
+};
+
+// Sends one request to the server at socketPath, copies the output and the
+// diagnostics to out and err and returns the program's exit status.
+int request(const std::string& socketPath, std::string_view program, std::string_view input,
+            std::ostream& out, std::ostream& err);
+
+} // namespace paracl::server
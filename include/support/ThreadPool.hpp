@@ -0,0 +1,177 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <utility>
+#include <exception>
+#include <functional>
+#include <condition_variable>
+
+namespace paracl::support
+{
+
+// Work-stealing pool: every worker owns a queue, takes its own newest
+// task first and steals the oldest task of another worker when it runs
+// dry. A task submitted from a worker goes to that worker's queue, so
+// related work stays on one thread.
+class ThreadPool final
+{
+public:
+    using Task = std::function<void()>;
+
+private:
+    struct Queue
+    {
+        std::mutex mutex_;
+        std::deque<Task> tasks_;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable idle_;
+    // Tasks in the queues that no worker has claimed yet.
+    size_t queued_ = 0;
+    // Tasks submitted and not finished.
+    size_t pending_ = 0;
+    size_t nextQueue_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+
+    struct Worker
+    {
+        const ThreadPool* pool_;
+        size_t index_;
+    };
+
+    static Worker& current() {
+        static thread_local Worker worker{nullptr, 0};
+        return worker;
+    }
+
+    bool take(Queue& queue, bool newest, Task& task) {
+        std::lock_guard<std::mutex> lock{queue.mutex_};
+        if (queue.tasks_.empty()) {
+            return false;
+        }
+        if (newest) {
+            task = std::move(queue.tasks_.back());
+            queue.tasks_.pop_back();
+        } else {
+            task = std::move(queue.tasks_.front());
+            queue.tasks_.pop_front();
+        }
+        return true;
+    }
+
+    // The caller has claimed a task, so one is bound to be found.
+    Task find(size_t index) {
+        Task task;
+        for (;;) {
+            if (take(*queues_[index], true, task)) {
+                return task;
+            }
+            for (size_t i = 1; i < queues_.size(); ++i) {
+                if (take(*queues_[(index + i) % queues_.size()], false, task)) {
+                    return task;
+                }
+            }
+            std::this_thread::yield();
+        }
+    }
+
+    void work(size_t index) {
+        current() = Worker{this, index};
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock{mutex_};
+                wake_.wait(lock, [this] { return stop_ || queued_ != 0; });
+                if (queued_ == 0) {
+                    return;
+                }
+                --queued_;
+            }
+            Task task = find(index);
+            std::exception_ptr error;
+            try {
+                task();
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (error && !error_) {
+                error_ = error;
+            }
+            if (--pending_ == 0) {
+                idle_.notify_all();
+            }
+        }
+    }
+
+public:
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency()) {
+        threads = threads ? threads : 1;
+        for (size_t i = 0; i < threads; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        for (size_t i = 0; i < threads; ++i) {
+            workers_.emplace_back([this, i] { work(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Finishes the queued tasks first.
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker: workers_) {
+            worker.join();
+        }
+    }
+
+    size_t size() const {
+        return workers_.size();
+    }
+
+    void submit(Task task) {
+        size_t index = current().index_;
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            if (current().pool_ != this) {
+                index = nextQueue_++ % queues_.size();
+            }
+            ++pending_;
+        }
+        {
+            std::lock_guard<std::mutex> lock{queues_[index]->mutex_};
+            queues_[index]->tasks_.push_back(std::move(task));
+        }
+        {
+            std::lock_guard<std::mutex> lock{mutex_};
+            ++queued_;
+        }
+        wake_.notify_one();
+    }
+
+    // Blocks until every submitted task has finished and rethrows the
+    // first exception a task let escape.
+    void wait() {
+        std::unique_lock<std::mutex> lock{mutex_};
+        idle_.wait(lock, [this] { return pending_ == 0; });
+        if (error_) {
+            std::rethrow_exception(std::exchange(error_, nullptr));
+        }
+    }
+};
+
+} // namespace paracl::support
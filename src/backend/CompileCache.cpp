@@ -0,0 +1,158 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <system_error>
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "backend/CompileCache.hpp"
+#include "support/Sha256.hpp"
+
+namespace paracl::backend
+{
+
+namespace fs = std::filesystem;
+
+namespace
+{
+
+// A temporary file this old belongs to a store() that never finished.
+constexpr auto abandonedAfter = std::chrono::hours{1};
+
+// Any rebuild of paracl changes the size or the modification time of the
+// binary, which stands in for a compiler version.
+std::string compilerIdentity() {
+    std::string identity = "pclb " + std::to_string(FileHeader::currentVersion);
+    struct stat st;
+    if (::stat("/proc/self/exe", &st) == 0) {
+        identity += ' ' + std::to_string(st.st_dev) + ' ' + std::to_string(st.st_ino) + ' ' +
+                    std::to_string(st.st_size) + ' ' + std::to_string(st.st_mtim.tv_sec) + '.' +
+                    std::to_string(st.st_mtim.tv_nsec);
+    }
+    return identity;
+}
+
+} // namespace
+
+CompileCache::CompileCache(const fs::path& dir, uintmax_t capacity)
+: dir_(dir), capacity_(capacity) {
+    std::error_code ec;
+    fs::create_directories(dir_, ec);
+}
+
+std::string CompileCache::key(std::string_view source, std::string_view options) {
+    static const std::string identity = compilerIdentity();
+    support::Sha256 hash;
+    // The NULs keep the fields apart.
+    hash.update(identity).update("", 1);
+    hash.update(options).update("", 1);
+    hash.update(source);
+    return support::Sha256::hex(hash.finish());
+}
+
+std::unique_ptr<Loader> CompileCache::find(const std::string& key) {
+    fs::path path = entry(key);
+    std::error_code ec;
+    if (!fs::exists(path, ec)) {
+        return nullptr;
+    }
+    std::unique_ptr<Loader> loader;
+    try {
+        loader = std::make_unique<Loader>(path.string());
+    } catch (const std::exception& ) {
+        fs::remove(path, ec);
+        return nullptr;
+    }
+    // The modification time orders entries for eviction.
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return loader;
+}
+
+void CompileCache::store(const std::string& key, const Program& program) {
+    fs::path path = entry(key);
+    // Unique per call: threads of one process may store the same key.
+    static std::atomic<uint64_t> stores{0};
+    fs::path temporary = path;
+    temporary += ".tmp" + std::to_string(::getpid()) + '-' +
+                 std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + '-' +
+                 std::to_string(stores.fetch_add(1, std::memory_order_relaxed));
+    std::error_code ec;
+    {
+        std::ofstream file{temporary, std::ios::binary};
+        if (!file) {
+            return;
+        }
+        try {
+            writeByteCode(file, program);
+            file.close();
+        } catch (const std::exception& ) {}
+        if (!file) {
+            fs::remove(temporary, ec);
+            return;
+        }
+    }
+    fs::rename(temporary, path, ec);
+    if (ec) {
+        fs::remove(temporary, ec);
+        return;
+    }
+    trim();
+}
+
+void CompileCache::trim() {
+    struct Entry
+    {
+        fs::path path_;
+        fs::file_time_type used_;
+        uintmax_t size_;
+    };
+
+    std::vector<Entry> entries;
+    uintmax_t total = 0;
+    auto now = fs::file_time_type::clock::now();
+    std::error_code ec;
+    for (fs::directory_iterator it{dir_, ec}, end; !ec && it != end; it.increment(ec)) {
+        std::error_code entryEc;
+        if (!it->is_regular_file(entryEc)) {
+            continue;
+        }
+        // Only entries count and are evicted; the directory may hold other
+        // files, and the temporary files of stores still in flight.
+        const fs::path& path = it->path();
+        if (path.extension() != ".pclb") {
+            auto modified = it->last_write_time(entryEc);
+            if (!entryEc && path.stem().extension() == ".pclb"
+                && path.extension().string().rfind(".tmp", 0) == 0 && now - modified > abandonedAfter) {
+                fs::remove(path, entryEc);
+            }
+            continue;
+        }
+        Entry entry{path, it->last_write_time(entryEc), it->file_size(entryEc)};
+        if (entryEc) {
+            continue;
+        }
+        total += entry.size_;
+        entries.push_back(std::move(entry));
+    }
+    if (total <= capacity_) {
+        return;
+    }
+    std::sort(entries.begin(), entries.end(), [](const Entry& lhs, const Entry& rhs) {
+        return lhs.used_ < rhs.used_;
+    });
+    // Another process may be trimming at the same time; a file it removed
+    // first is just skipped.
+    for (const auto& entry: entries) {
+        if (total <= capacity_) {
+            break;
+        }
+        fs::remove(entry.path_, ec);
+        total -= entry.size_;
+    }
+}
+
+} // namespace paracl::backend
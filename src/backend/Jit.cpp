@@ -0,0 +1,492 @@
+#include "backend/Jit.hpp"
+
+#ifdef PARACL_JIT
+
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/mman.h>
+
+namespace paracl::backend
+{
+
+namespace
+{
+
+enum Register : uint8_t
+{
+    EAX = 0,
+    ECX = 1,
+    EDX = 2,
+};
+
+// Condition codes of the SETcc/Jcc opcode families.
+enum Condition : uint8_t
+{
+    CC_BE = 0x6,
+    CC_E  = 0x4,
+    CC_NE = 0x5,
+    CC_L  = 0xC,
+    CC_GE = 0xD,
+    CC_LE = 0xE,
+    CC_G  = 0xF,
+};
+
+// Just the x86-64 encodings the templates need. The frame pointer stays
+// in rdi (the first argument) and every slot is addressed as [rdi + disp32].
+class Assembler final
+{
+private:
+    std::vector<uint8_t> code_;
+
+    void byte(uint8_t value) {
+        code_.push_back(value);
+    }
+
+    void dword(int32_t value) {
+        uint8_t bytes[4];
+        std::memcpy(bytes, &value, sizeof(bytes));
+        code_.insert(code_.end(), bytes, bytes + 4);
+    }
+
+    // ModRM for [rdi + disp32] with `reg` in the reg field.
+    void slot(uint8_t reg, int32_t index) {
+        byte(0x80 | (reg << 3) | 0x7);
+        dword(index * 4);
+    }
+
+public:
+    size_t size() const {
+        return code_.size();
+    }
+
+    const std::vector<uint8_t>& code() const {
+        return code_;
+    }
+
+    void load(Register reg, int32_t index) {
+        byte(0x8B);
+        slot(reg, index);
+    }
+
+    void store(int32_t index, Register reg) {
+        byte(0x89);
+        slot(reg, index);
+    }
+
+    void storeImm(int32_t index, int32_t imm) {
+        byte(0xC7);
+        slot(0, index);
+        dword(imm);
+    }
+
+    void movImm(Register reg, int32_t imm) {
+        byte(0xB8 + reg);
+        dword(imm);
+    }
+
+    // mov rax, imm64; cmp byte [rax], 0
+    void testFlag(const void* flag) {
+        auto address = reinterpret_cast<uint64_t>(flag);
+        byte(0x48);
+        byte(0xB8);
+        dword(static_cast<int32_t>(address));
+        dword(static_cast<int32_t>(address >> 32));
+        byte(0x80);
+        byte(0x38);
+        byte(0x00);
+    }
+
+    void addMem(int32_t index) {
+        byte(0x03);
+        slot(EAX, index);
+    }
+
+    void subMem(int32_t index) {
+        byte(0x2B);
+        slot(EAX, index);
+    }
+
+    void imulMem(int32_t index) {
+        byte(0x0F);
+        byte(0xAF);
+        slot(EAX, index);
+    }
+
+    void cmpMem(int32_t index) {
+        byte(0x3B);
+        slot(EAX, index);
+    }
+
+    void addImm(int32_t imm) {
+        byte(0x05);
+        dword(imm);
+    }
+
+    void subImm(int32_t imm) {
+        byte(0x2D);
+        dword(imm);
+    }
+
+    void imulImm(int32_t imm) {
+        byte(0x69);
+        byte(0xC0);
+        dword(imm);
+    }
+
+    void cmpImm(int32_t imm) {
+        byte(0x3D);
+        dword(imm);
+    }
+
+    void incMem(int32_t index) {
+        byte(0xFF);
+        slot(0, index);
+    }
+
+    void decMem(int32_t index) {
+        byte(0xFF);
+        slot(1, index);
+    }
+
+    void neg() {
+        byte(0xF7);
+        byte(0xD8);
+    }
+
+    void test() {
+        byte(0x85);
+        byte(0xC0);
+    }
+
+    // eax = condition ? 1 : 0
+    void set(Condition cc) {
+        byte(0x0F);
+        byte(0x90 | cc);
+        byte(0xC0);
+        byte(0x0F);
+        byte(0xB6);
+        byte(0xC0);
+    }
+
+    // Leaves the quotient in eax and the remainder in edx.
+    void idiv() {
+        byte(0x99);
+        byte(0xF7);
+        byte(0xF9);
+    }
+
+    // edx = ecx + 1, compared with 1: below-or-equal iff ecx is 0 or -1.
+    void cmpDivisor() {
+        byte(0x8D);
+        byte(0x51);
+        byte(0x01);
+        byte(0x83);
+        byte(0xFA);
+        byte(0x01);
+    }
+
+    // The jumps return the offset of their rel32 field for patching.
+    size_t jmp() {
+        byte(0xE9);
+        dword(0);
+        return size() - 4;
+    }
+
+    size_t jcc(Condition cc) {
+        byte(0x0F);
+        byte(0x80 | cc);
+        dword(0);
+        return size() - 4;
+    }
+
+    void patch(size_t field, size_t target) {
+        int32_t rel = static_cast<int32_t>(target) - static_cast<int32_t>(field + 4);
+        std::memcpy(code_.data() + field, &rel, sizeof(rel));
+    }
+
+    void ret() {
+        byte(0xC3);
+    }
+};
+
+class LoopCompiler final
+{
+private:
+    struct Fixup
+    {
+        size_t field_;
+        uint32_t target_;
+    };
+
+    const ProgramView& program_;
+    size_t header_;
+    size_t end_;
+    const std::atomic<bool>* interrupt_;
+    Assembler as_;
+    std::vector<size_t> labels_;
+    std::vector<Fixup> jumps_;
+    std::vector<Fixup> exits_;
+
+    bool inside(int32_t pc) const {
+        return static_cast<size_t>(pc) >= header_ && static_cast<size_t>(pc) <= end_;
+    }
+
+    void exitTo(size_t field, uint32_t pc) {
+        exits_.push_back(Fixup{field, pc});
+    }
+
+    void jumpTo(size_t field, int32_t target) {
+        if (inside(target)) {
+            jumps_.push_back(Fixup{field, static_cast<uint32_t>(target)});
+        } else {
+            exitTo(field, static_cast<uint32_t>(target));
+        }
+    }
+
+    void binary(const Instruction& instr) {
+        as_.load(EAX, instr.b_);
+        switch (instr.op_) {
+        case Opcode::ADD: as_.addMem(instr.c_); break;
+        case Opcode::SUB: as_.subMem(instr.c_); break;
+        case Opcode::MUL: as_.imulMem(instr.c_); break;
+        case Opcode::ADDI: as_.addImm(instr.c_); break;
+        case Opcode::SUBI: as_.subImm(instr.c_); break;
+        case Opcode::MULI: as_.imulImm(instr.c_); break;
+        default: break;
+        }
+        as_.store(instr.a_, EAX);
+    }
+
+    void compare(const Instruction& instr, Condition cc, bool immediate) {
+        as_.load(EAX, instr.b_);
+        if (immediate) {
+            as_.cmpImm(instr.c_);
+        } else {
+            as_.cmpMem(instr.c_);
+        }
+        as_.set(cc);
+        as_.store(instr.a_, EAX);
+    }
+
+    void branch(const Instruction& instr, Condition cc, bool immediate) {
+        as_.load(EAX, instr.a_);
+        if (immediate) {
+            as_.cmpImm(instr.b_);
+        } else {
+            as_.cmpMem(instr.b_);
+        }
+        jumpTo(as_.jcc(cc), instr.c_);
+    }
+
+    // Division by 0 throws and INT_MIN / -1 traps in hardware, so both
+    // divisors are left to the interpreter.
+    void divide(const Instruction& instr, uint32_t pc, bool immediate, bool modulo) {
+        if (immediate) {
+            if (instr.c_ == 0 || instr.c_ == -1) {
+                exitTo(as_.jmp(), pc);
+                return;
+            }
+            as_.movImm(ECX, instr.c_);
+        } else {
+            as_.load(ECX, instr.c_);
+            as_.cmpDivisor();
+            exitTo(as_.jcc(CC_BE), pc);
+        }
+        as_.load(EAX, instr.b_);
+        as_.idiv();
+        as_.store(instr.a_, modulo ? EDX : EAX);
+    }
+
+    void instruction(const Instruction& instr, uint32_t pc) {
+        switch (instr.op_) {
+        case Opcode::MOV:
+            as_.load(EAX, instr.b_);
+            as_.store(instr.a_, EAX);
+            return;
+        case Opcode::LOADI:
+            as_.storeImm(instr.a_, instr.b_);
+            return;
+        case Opcode::ADD:
+        case Opcode::SUB:
+        case Opcode::MUL:
+        case Opcode::ADDI:
+        case Opcode::SUBI:
+        case Opcode::MULI:
+            binary(instr);
+            return;
+        case Opcode::DIV: divide(instr, pc, false, false); return;
+        case Opcode::MOD: divide(instr, pc, false, true); return;
+        case Opcode::DIVI: divide(instr, pc, true, false); return;
+        case Opcode::MODI: divide(instr, pc, true, true); return;
+        case Opcode::LT: compare(instr, CC_L, false); return;
+        case Opcode::GT: compare(instr, CC_G, false); return;
+        case Opcode::LE: compare(instr, CC_LE, false); return;
+        case Opcode::GE: compare(instr, CC_GE, false); return;
+        case Opcode::EQ: compare(instr, CC_E, false); return;
+        case Opcode::NE: compare(instr, CC_NE, false); return;
+        case Opcode::LTI: compare(instr, CC_L, true); return;
+        case Opcode::GTI: compare(instr, CC_G, true); return;
+        case Opcode::LEI: compare(instr, CC_LE, true); return;
+        case Opcode::GEI: compare(instr, CC_GE, true); return;
+        case Opcode::EQI: compare(instr, CC_E, true); return;
+        case Opcode::NEI: compare(instr, CC_NE, true); return;
+        case Opcode::NEG:
+            as_.load(EAX, instr.b_);
+            as_.neg();
+            as_.store(instr.a_, EAX);
+            return;
+        case Opcode::NOT:
+        case Opcode::BOOL:
+            as_.load(EAX, instr.b_);
+            as_.test();
+            as_.set(instr.op_ == Opcode::NOT ? CC_E : CC_NE);
+            as_.store(instr.a_, EAX);
+            return;
+        case Opcode::INC:
+            as_.incMem(instr.a_);
+            return;
+        case Opcode::DEC:
+            as_.decMem(instr.a_);
+            return;
+        case Opcode::JMP:
+            jumpTo(as_.jmp(), instr.c_);
+            return;
+        case Opcode::JZ:
+        case Opcode::JNZ:
+            as_.load(EAX, instr.a_);
+            as_.test();
+            jumpTo(as_.jcc(instr.op_ == Opcode::JZ ? CC_E : CC_NE), instr.c_);
+            return;
+        case Opcode::JLT: branch(instr, CC_L, false); return;
+        case Opcode::JGT: branch(instr, CC_G, false); return;
+        case Opcode::JLE: branch(instr, CC_LE, false); return;
+        case Opcode::JGE: branch(instr, CC_GE, false); return;
+        case Opcode::JEQ: branch(instr, CC_E, false); return;
+        case Opcode::JNE: branch(instr, CC_NE, false); return;
+        case Opcode::JLTI: branch(instr, CC_L, true); return;
+        case Opcode::JGTI: branch(instr, CC_G, true); return;
+        case Opcode::JLEI: branch(instr, CC_LE, true); return;
+        case Opcode::JGEI: branch(instr, CC_GE, true); return;
+        case Opcode::JEQI: branch(instr, CC_E, true); return;
+        case Opcode::JNEI: branch(instr, CC_NE, true); return;
+        case Opcode::DEC_JNZ:
+            as_.decMem(instr.a_);
+            jumpTo(as_.jcc(CC_NE), instr.c_);
+            return;
+        case Opcode::HALT:
+        case Opcode::IN:
+        case Opcode::OUT:
+            break;
+        }
+        exitTo(as_.jmp(), pc);
+    }
+
+public:
+    LoopCompiler(const ProgramView& program, size_t header, size_t end, const std::atomic<bool>* interrupt)
+    : program_(program), header_(header), end_(end), interrupt_(interrupt) {}
+
+    const std::vector<uint8_t>& compile() {
+        // Targets of backward jumps inside the region: the header and the
+        // headers of nested loops.
+        std::vector<bool> loopHeads(end_ - header_ + 1, false);
+        for (size_t pc = header_; pc <= end_; ++pc) {
+            const Instruction& instr = program_.code_[pc];
+            if (operandKinds(instr.op_).c_ == OperandKind::TARGET && inside(instr.c_)
+                && static_cast<size_t>(instr.c_) <= pc) {
+                loopHeads[instr.c_ - header_] = true;
+            }
+        }
+        for (size_t pc = header_; pc <= end_; ++pc) {
+            labels_.push_back(as_.size());
+            // Every iteration of every loop in the region passes one of
+            // these; the interpreter resumes there and notices the
+            // interrupt at its next back-edge.
+            if (loopHeads[pc - header_] && interrupt_) {
+                as_.testFlag(interrupt_);
+                exitTo(as_.jcc(CC_NE), static_cast<uint32_t>(pc));
+            }
+            instruction(program_.code_[pc], static_cast<uint32_t>(pc));
+        }
+        // A conditional back-edge falls through out of the loop.
+        exitTo(as_.jmp(), static_cast<uint32_t>(end_ + 1));
+        for (const auto& jump: jumps_) {
+            as_.patch(jump.field_, labels_[jump.target_ - header_]);
+        }
+        // One `mov eax, pc; ret` stub per distinct exit.
+        std::vector<std::pair<uint32_t, size_t>> stubs;
+        for (const auto& exit: exits_) {
+            size_t stub = SIZE_MAX;
+            for (const auto& [pc, offset]: stubs) {
+                if (pc == exit.target_) {
+                    stub = offset;
+                }
+            }
+            if (stub == SIZE_MAX) {
+                stub = as_.size();
+                stubs.emplace_back(exit.target_, stub);
+                as_.movImm(EAX, static_cast<int32_t>(exit.target_));
+                as_.ret();
+            }
+            as_.patch(exit.field_, stub);
+        }
+        return as_.code();
+    }
+};
+
+} // namespace
+
+Jit::Entry Jit::compile(size_t header) {
+    // The loop extends to the last back-edge into its header: the while
+    // statement's own condition comes after every `continue`.
+    size_t end = header;
+    for (size_t pc = header; pc < program_.size_; ++pc) {
+        const Instruction& instr = program_.code_[pc];
+        if (operandKinds(instr.op_).c_ == OperandKind::TARGET && static_cast<size_t>(instr.c_) == header) {
+            end = pc;
+        }
+    }
+    if (end == header) {
+        return nullptr;
+    }
+
+    LoopCompiler compiler{program_, header, end, interrupt_};
+    const std::vector<uint8_t>& code = compiler.compile();
+
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    size_t size = (code.size() + page - 1) / page * page;
+    void* memory = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        return nullptr;
+    }
+    std::memcpy(memory, code.data(), code.size());
+    if (::mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        ::munmap(memory, size);
+        return nullptr;
+    }
+    regions_.push_back(Region{memory, size});
+    return reinterpret_cast<Entry>(memory);
+}
+
+Jit::~Jit() {
+    for (const auto& region: regions_) {
+        ::munmap(region.memory_, region.size_);
+    }
+}
+
+} // namespace paracl::backend
+
+#else
+
+namespace paracl::backend
+{
+
+Jit::Entry Jit::compile(size_t ) {
+    return nullptr;
+}
+
+Jit::~Jit() = default;
+
+} // namespace paracl::backend
+
+#endif
@@ -0,0 +1,164 @@
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "backend/Loader.hpp"
+
+namespace paracl::backend
+{
+
+namespace
+{
+
+// Frames are allocated up front, so a corrupted header must not be able
+// to request gigabytes of slots.
+constexpr uint32_t maxFrameSize = 1u << 24;
+
+bool checkOperand(OperandKind kind, int32_t value, const FileHeader& header) {
+    switch (kind) {
+    case OperandKind::SLOT:
+        return value >= 0 && static_cast<uint32_t>(value) < header.frameSize_;
+    case OperandKind::TARGET:
+        return value >= 0 && static_cast<uint32_t>(value) < header.instructions_;
+    case OperandKind::NONE:
+    case OperandKind::IMM:
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+void writeRaw(std::ostream& os, const T* data, size_t count) {
+    os.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(sizeof(T) * count));
+}
+
+} // namespace
+
+void writeByteCode(std::ostream& os, const Program& program) {
+    ProgramView view = program.view();
+    FileHeader header;
+    header.frameSize_ = view.frameSize_;
+    header.instructions_ = static_cast<uint32_t>(view.size_);
+    header.locations_ = view.locations_ ? header.instructions_ : 0;
+
+    // Instructions have padding after the opcode. Copy them field by field
+    // into zeroed memory so that a program always gives the same bytes.
+    std::vector<Instruction> code(view.size_);
+    std::memset(static_cast<void*>(code.data()), 0, sizeof(Instruction) * code.size());
+    for (size_t i = 0; i < view.size_; ++i) {
+        code[i].op_ = view.code_[i].op_;
+        code[i].a_ = view.code_[i].a_;
+        code[i].b_ = view.code_[i].b_;
+        code[i].c_ = view.code_[i].c_;
+    }
+
+    writeRaw(os, &header, 1);
+    writeRaw(os, code.data(), code.size());
+    if (view.locations_) {
+        writeRaw(os, view.locations_, view.size_);
+    }
+    if (!os) {
+        throw std::runtime_error("can not write bytecode");
+    }
+}
+
+ProgramView verifyByteCode(const void* data, size_t size) {
+    if (size < sizeof(FileHeader)) {
+        throw std::runtime_error("bytecode: truncated header");
+    }
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic_, FileHeader::magic, sizeof(header.magic_)) != 0) {
+        throw std::runtime_error("bytecode: bad magic");
+    }
+    if (header.version_ != FileHeader::currentVersion) {
+        throw std::runtime_error("bytecode: unsupported version " + std::to_string(header.version_));
+    }
+    if (header.byteOrder_ != FileHeader::byteOrderMark) {
+        throw std::runtime_error("bytecode: foreign byte order");
+    }
+    if (header.frameSize_ > maxFrameSize) {
+        throw std::runtime_error("bytecode: frame is too large");
+    }
+    if (header.instructions_ == 0) {
+        throw std::runtime_error("bytecode: empty code section");
+    }
+    if (header.locations_ != 0 && header.locations_ != header.instructions_) {
+        throw std::runtime_error("bytecode: location table does not match code");
+    }
+    uint64_t expected = sizeof(FileHeader)
+        + uint64_t{header.constants_} * sizeof(int32_t)
+        + uint64_t{header.instructions_} * sizeof(Instruction)
+        + uint64_t{header.locations_} * sizeof(SourceLocation);
+    if (expected != size) {
+        throw std::runtime_error("bytecode: section sizes do not match the file size");
+    }
+
+    auto bytes = static_cast<const char*>(data);
+    auto code = reinterpret_cast<const Instruction*>(
+        bytes + sizeof(FileHeader) + size_t{header.constants_} * sizeof(int32_t));
+    for (uint32_t i = 0; i < header.instructions_; ++i) {
+        const Instruction& instr = code[i];
+        if (static_cast<size_t>(instr.op_) >= opcodeCount) {
+            throw std::runtime_error("bytecode: unknown opcode at " + std::to_string(i));
+        }
+        OperandKinds kinds = operandKinds(instr.op_);
+        if (!checkOperand(kinds.a_, instr.a_, header) ||
+            !checkOperand(kinds.b_, instr.b_, header) ||
+            !checkOperand(kinds.c_, instr.c_, header)) {
+            throw std::runtime_error("bytecode: operand out of range at " + std::to_string(i));
+        }
+    }
+    Opcode last = code[header.instructions_ - 1].op_;
+    if (last != Opcode::HALT && last != Opcode::JMP) {
+        throw std::runtime_error("bytecode: code falls off the end");
+    }
+
+    auto locations = header.locations_ == 0 ? nullptr :
+        reinterpret_cast<const SourceLocation*>(code + header.instructions_);
+    return ProgramView{code, header.instructions_, header.frameSize_, locations};
+}
+
+bool isByteCodeFile(const std::string& path) {
+    std::ifstream file{path, std::ios::binary};
+    char magic[sizeof(FileHeader::magic)] = {};
+    file.read(magic, sizeof(magic));
+    return file && std::memcmp(magic, FileHeader::magic, sizeof(magic)) == 0;
+}
+
+Loader::Loader(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("can not open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(FileHeader))) {
+        ::close(fd);
+        throw std::runtime_error("bytecode: truncated header");
+    }
+    size_ = static_cast<size_t>(st.st_size);
+    void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("can not map " + path);
+    }
+    data_ = data;
+    try {
+        program_ = verifyByteCode(data_, size_);
+    } catch (...) {
+        ::munmap(data_, size_);
+        throw;
+    }
+}
+
+Loader::~Loader() {
+    ::munmap(data_, size_);
+}
+
+} // namespace paracl::backend
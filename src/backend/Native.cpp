@@ -0,0 +1,115 @@
+#include <stdexcept>
+
+#include <llvm/ExecutionEngine/Orc/LLJIT.h>
+#include <llvm/ExecutionEngine/Orc/ExecutionUtils.h>
+#include <llvm/ExecutionEngine/Orc/ThreadSafeModule.h>
+#include <llvm/IR/LegacyPassManager.h>
+#include <llvm/IR/PassManager.h>
+#include <llvm/MC/TargetRegistry.h>
+#include <llvm/Passes/PassBuilder.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Host.h>
+#include <llvm/Support/raw_ostream.h>
+#include <llvm/Support/TargetSelect.h>
+#include <llvm/Target/TargetMachine.h>
+#include <llvm/Target/TargetOptions.h>
+#include <llvm/Transforms/Utils/Mem2Reg.h>
+
+#include "backend/Native.hpp"
+
+namespace paracl::backend
+{
+
+namespace
+{
+
+void initializeTarget() {
+    static bool initialized = [] {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        llvm::InitializeNativeTargetAsmParser();
+        return true;
+    }();
+    (void)initialized;
+}
+
+template<typename T>
+T check(llvm::Expected<T> value) {
+    if (!value) {
+        throw std::runtime_error(llvm::toString(value.takeError()));
+    }
+    return std::move(*value);
+}
+
+void check(llvm::Error error) {
+    if (error) {
+        throw std::runtime_error(llvm::toString(std::move(error)));
+    }
+}
+
+} // namespace
+
+void optimizeModule(llvm::Module& module, bool full) {
+    llvm::LoopAnalysisManager lam;
+    llvm::FunctionAnalysisManager fam;
+    llvm::CGSCCAnalysisManager cgam;
+    llvm::ModuleAnalysisManager mam;
+    llvm::PassBuilder builder;
+    builder.registerModuleAnalyses(mam);
+    builder.registerCGSCCAnalyses(cgam);
+    builder.registerFunctionAnalyses(fam);
+    builder.registerLoopAnalyses(lam);
+    builder.crossRegisterProxies(lam, fam, cgam, mam);
+
+    if (full) {
+        builder.buildPerModuleDefaultPipeline(llvm::OptimizationLevel::O2).run(module, mam);
+        return;
+    }
+    llvm::FunctionPassManager fpm;
+    fpm.addPass(llvm::PromotePass{});
+    llvm::ModulePassManager mpm;
+    mpm.addPass(llvm::createModuleToFunctionPassAdaptor(std::move(fpm)));
+    mpm.run(module, mam);
+}
+
+int runNative(std::unique_ptr<llvm::LLVMContext> context, std::unique_ptr<llvm::Module> module) {
+    initializeTarget();
+    auto jit = check(llvm::orc::LLJITBuilder().create());
+    // printf, scanf and friends resolve against the running process.
+    auto& layout = jit->getDataLayout();
+    jit->getMainJITDylib().addGenerator(check(
+        llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(layout.getGlobalPrefix())));
+    module->setDataLayout(layout);
+    check(jit->addIRModule(llvm::orc::ThreadSafeModule{std::move(module), std::move(context)}));
+    auto main = check(jit->lookup("main"));
+    auto entry = reinterpret_cast<int (*)()>(main.getAddress());
+    return entry();
+}
+
+void emitObject(llvm::Module& module, const std::string& path) {
+    initializeTarget();
+    std::string triple = llvm::sys::getDefaultTargetTriple();
+    std::string error;
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (!target) {
+        throw std::runtime_error(error);
+    }
+    std::unique_ptr<llvm::TargetMachine> machine{target->createTargetMachine(
+        triple, "generic", "", llvm::TargetOptions{}, llvm::Reloc::PIC_)};
+    module.setTargetTriple(triple);
+    module.setDataLayout(machine->createDataLayout());
+
+    std::error_code ec;
+    llvm::raw_fd_ostream out{path, ec, llvm::sys::fs::OF_None};
+    if (ec) {
+        throw std::runtime_error("can not open " + path + ": " + ec.message());
+    }
+    llvm::legacy::PassManager passes;
+    if (machine->addPassesToEmitFile(passes, out, nullptr, llvm::CGFT_ObjectFile)) {
+        throw std::runtime_error("the target can not emit object files");
+    }
+    passes.run(module);
+    out.flush();
+}
+
+} // namespace paracl::backend
@@ -0,0 +1,144 @@
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <unistd.h>
+
+#include "backend/RuntimeIO.hpp"
+
+namespace paracl::backend
+{
+
+namespace
+{
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+} // namespace
+
+bool Input::fill() {
+    if (eof_) {
+        return false;
+    }
+    if (begin_ != 0) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    if (end_ == buffer_.size()) {
+        buffer_.resize(buffer_.size() * 2);
+    }
+    size_t room = buffer_.size() - end_;
+    if (stream_) {
+        // sgetn on a terminal would wait for the whole buffer, so take
+        // what is available and at least one character.
+        std::streambuf* buf = stream_->rdbuf();
+        std::streamsize avail = buf->in_avail();
+        auto want = static_cast<std::streamsize>(avail > 0 ? std::min(room, static_cast<size_t>(avail)) : 1);
+        std::streamsize got = buf->sgetn(buffer_.data() + end_, want);
+        if (got <= 0) {
+            eof_ = true;
+            return false;
+        }
+        end_ += static_cast<size_t>(got);
+        return true;
+    }
+    ssize_t got;
+    do {
+        got = ::read(fd_, buffer_.data() + end_, room);
+    } while (got < 0 && errno == EINTR);
+    if (got <= 0) {
+        eof_ = true;
+        return false;
+    }
+    end_ += static_cast<size_t>(got);
+    return true;
+}
+
+bool Input::readSlow(int32_t& value) {
+    for (;;) {
+        while (begin_ != end_ && isSpace(buffer_[begin_])) {
+            ++begin_;
+        }
+        if (begin_ != end_ || !fill()) {
+            break;
+        }
+    }
+    if (begin_ == end_) {
+        return false;
+    }
+    // Make sure the whole token is buffered: it ends at the first
+    // character that is not a digit, or at the end of input.
+    size_t pos = begin_;
+    if (buffer_[pos] == '+' || buffer_[pos] == '-') {
+        ++pos;
+    }
+    for (;;) {
+        while (pos != end_ && isDigit(buffer_[pos])) {
+            ++pos;
+        }
+        if (pos != end_) {
+            break;
+        }
+        // fill() moves the unread bytes to the front of the buffer.
+        size_t offset = pos - begin_;
+        bool more = fill();
+        pos = begin_ + offset;
+        if (!more) {
+            break;
+        }
+    }
+    const char* first = buffer_.data() + begin_;
+    // from_chars does not take a plus sign, operator>> does.
+    if (*first == '+' && first + 1 != buffer_.data() + pos && first[1] != '-') {
+        ++first;
+    }
+    auto [ptr, ec] = std::from_chars(first, buffer_.data() + pos, value);
+    if (ec != std::errc{}) {
+        return false;
+    }
+    begin_ = ptr - buffer_.data();
+    return true;
+}
+
+Output::~Output() {
+    try {
+        flush();
+    } catch (...) {}
+}
+
+void Output::flush() {
+    if (size_ == 0) {
+        return;
+    }
+    size_t size = size_;
+    size_ = 0;
+    if (stream_) {
+        stream_->write(buffer_.data(), static_cast<std::streamsize>(size));
+        stream_->flush();
+        if (!*stream_) {
+            throw std::runtime_error("can not write output");
+        }
+        return;
+    }
+    const char* data = buffer_.data();
+    while (size != 0) {
+        ssize_t written = ::write(fd_, data, size);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(std::string{"can not write output: "} + std::strerror(errno));
+        }
+        data += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+} // namespace paracl::backend
@@ -1 +1,179 @@
-#include "../../include/backend/VM.hpp"
+#include <string>
+#include <vector>
+#include <optional>
+#include <algorithm>
+#include <stdexcept>
+
+#include "backend/VM.hpp"
+#include "backend/Arithmetic.hpp"
+
+namespace paracl::backend
+{
+
+namespace
+{
+
+// Direct-threaded form of an Instruction: the opcode is replaced by the
+// address of its handler, so dispatch is a single indirect jump.
+struct ThreadedInstruction
+{
+    const void* handler_;
+    int32_t a_;
+    int32_t b_;
+    int32_t c_;
+};
+
+} // namespace
+
+void Executer::fail(const ProgramView& program, size_t pc, const std::exception& e) {
+    if (!program.locations_) {
+        throw std::runtime_error(e.what());
+    }
+    const SourceLocation& loc = program.locations_[pc];
+    throw std::runtime_error(std::to_string(loc.line_) + "." + std::to_string(loc.column_) +
+                             " error: " + e.what());
+}
+
+void Executer::run(const ProgramView& program, Dispatch dispatch) {
+    std::vector<int32_t> frame;
+    run(program, frame, dispatch);
+    out_.flush();
+}
+
+void Executer::run(const ProgramView& program, std::vector<int32_t>& frame, Dispatch dispatch) {
+    if (frame.size() < program.frameSize_) {
+        frame.resize(program.frameSize_, 0);
+    }
+    executed_ = 0;
+    std::optional<Jit> jit;
+#ifdef PARACL_JIT
+    if (jitEnabled_ && profile_ == Profile::NONE) {
+        jit.emplace(program, interrupt_);
+    }
+#endif
+    jit_ = jit ? &*jit : nullptr;
+    switch (profile_) {
+    case Profile::NONE:
+        execute<Profile::NONE>(program, frame.data(), dispatch);
+        return;
+    case Profile::COUNT:
+        execute<Profile::COUNT>(program, frame.data(), dispatch);
+        return;
+    case Profile::PAIRS:
+        pairs_.assign(opcodeCount * opcodeCount, 0);
+        previous_ = static_cast<size_t>(Opcode::HALT);
+        execute<Profile::PAIRS>(program, frame.data(), dispatch);
+        return;
+    }
+}
+
+std::vector<PairCount> Executer::hottestPairs(size_t limit) const {
+    std::vector<PairCount> pairs;
+    for (size_t i = 0; i < pairs_.size(); ++i) {
+        if (pairs_[i]) {
+            pairs.push_back(PairCount{static_cast<Opcode>(i / opcodeCount),
+                                      static_cast<Opcode>(i % opcodeCount), pairs_[i]});
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const PairCount& lhs, const PairCount& rhs) {
+        return lhs.count_ > rhs.count_;
+    });
+    if (pairs.size() > limit) {
+        pairs.resize(limit);
+    }
+    return pairs;
+}
+
+template<Profile P>
+void Executer::execute(const ProgramView& program, int32_t* regs, Dispatch dispatch) {
+#ifdef PARACL_THREADED_DISPATCH
+    if (dispatch == Dispatch::THREADED) {
+        runThreaded<P>(program, regs);
+        return;
+    }
+#else
+    (void)dispatch;
+#endif
+    runSwitch<P>(program, regs);
+}
+
+template<Profile P>
+void Executer::runSwitch(const ProgramView& program, int32_t* regs) {
+    const Instruction* code = program.code_;
+    const Instruction* ip = code;
+
+#define HANDLER(op) case Opcode::op:
+#define RETIRE() if constexpr (P != Profile::NONE) { retire<P>(ip->op_); }
+#define NEXT() RETIRE(); ++ip; continue
+#define JUMP(target) RETIRE(); ip = code + (target); continue
+
+    try {
+        for (;;) {
+            switch (ip->op_) {
+#include "VMHandlers.inc"
+            }
+            throw std::runtime_error("unknown opcode");
+        }
+    } catch (const std::runtime_error& e) {
+        fail(program, ip - code, e);
+    }
+
+#undef HANDLER
+#undef RETIRE
+#undef NEXT
+#undef JUMP
+}
+
+#ifdef PARACL_THREADED_DISPATCH
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+
+template<Profile P>
+void Executer::runThreaded(const ProgramView& program, int32_t* regs) {
+    static const void* const handlers[] = {
+#define OPCODE(name, a, b, c) &&HANDLER_##name,
+        PARACL_OPCODES(OPCODE)
+#undef OPCODE
+    };
+
+    std::vector<ThreadedInstruction> threaded;
+    threaded.reserve(program.size_);
+    for (size_t i = 0; i < program.size_; ++i) {
+        const Instruction& instr = program.code_[i];
+        threaded.push_back(ThreadedInstruction{
+            handlers[static_cast<uint8_t>(instr.op_)], instr.a_, instr.b_, instr.c_});
+    }
+    const ThreadedInstruction* code = threaded.data();
+    const ThreadedInstruction* ip = code;
+
+#define HANDLER(op) HANDLER_##op:
+#define RETIRE() if constexpr (P != Profile::NONE) { retire<P>(program.code_[ip - code].op_); }
+#define NEXT() RETIRE(); ++ip; goto *ip->handler_
+#define JUMP(target) RETIRE(); ip = code + (target); goto *ip->handler_
+
+    try {
+        goto *ip->handler_;
+#include "VMHandlers.inc"
+    } catch (const std::runtime_error& e) {
+        fail(program, ip - code, e);
+    }
+
+#undef HANDLER
+#undef RETIRE
+#undef NEXT
+#undef JUMP
+}
+
+#pragma GCC diagnostic pop
+
+#else
+
+template<Profile P>
+void Executer::runThreaded(const ProgramView& program, int32_t* regs) {
+    runSwitch<P>(program, regs);
+}
+
+#endif
+
+} // namespace paracl::backend
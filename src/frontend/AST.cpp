@@ -3,6 +3,9 @@
 #include "frontend/NodeCopier.hpp"
 #include "frontend/NodeDumper.hpp"
 #include "frontend/NodeSemanticAnalyzer.hpp"
+#include "frontend/NodeCodeGenerator.hpp"
+#include "frontend/NodeOptimizer.hpp"
+#include "frontend/NodeFlattener.hpp"
 
 namespace paracl::frontend
 {
@@ -11,13 +14,14 @@ void INode::accept(NodeVisitor& visitor) {
     visitor.visit(this);
 }
 
-AST::AST(const AST& rhs) {
-    NodeCopier copier{*this};
+AST::AST(const AST& rhs)
+: lines_(rhs.lines_) {
+    NodeCopier copier{*this, rhs.size()};
     root_ = copier.copy(rhs.root_);
 }
 
-void AST::dump(std::ostream& os) const {
-    NodeDumper dumper{os};
+void AST::dump(std::ostream& os, const Interner& names) const {
+    NodeDumper dumper{os, names, lines_};
     dumper.dump(root_);
 }
 
@@ -26,4 +30,22 @@ void AST::semanticAnalyze(Driver& driver) {
     analyzer.analyze(root_);
 }
 
+size_t AST::optimize() {
+    NodeOptimizer optimizer{*this};
+    root_ = optimizer.optimize(root_);
+    return optimizer.removed();
+}
+
+void AST::compile(backend::Program& program, size_t memoryLimit) const {
+    NodeCodeGenerator generator{program, lines_, memoryLimit};
+    generator.generate(root_);
+}
+
+FlatAST AST::flatten() const {
+    FlatAST flat;
+    NodeFlattener flattener{flat, nodes_};
+    flattener.flatten(root_);
+    return flat;
+}
+
 } // namespace paracl::frontend
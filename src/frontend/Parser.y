@@ -18,6 +18,7 @@
 {
     #include <stdexcept>
     #include "frontend/AST.hpp"
+    #include "frontend/Location.hpp"
 
     namespace paracl::frontend
     {
@@ -38,6 +39,11 @@
     {
     
     inline paracl::frontend::Parser::symbol_type yylex(paracl::frontend::Driver& driver) {
+        driver.checkInterrupt();
+        Statistics* stats = driver.getStats();
+        if (stats->enabled()) {
+            stats->countToken();
+        }
         return driver.getLexer()->getNextToken();
     }
 
@@ -49,7 +55,7 @@
 
 %define api.token.prefix {TOKEN_}
 %locations
-%define api.location.file "location.hpp"
+%define api.location.type { paracl::frontend::SourceRange }
 
 %token
     BREAK       "break"
@@ -99,7 +105,7 @@
 
 %token
     <int>         CONSTANT   "constant"
-    <std::string> IDENTIFIER "identifier"
+    <SymbolId> IDENTIFIER "identifier"
 
 %type <paracl::frontend::Expression*>
     primary_expression
@@ -122,6 +128,7 @@
 
 %type <paracl::frontend::BlockStatement*>
     statement_list
+    top_statement_list
 
 %type <paracl::frontend::Statement*>
     expression_statement
@@ -222,7 +229,7 @@
         | statement_list error SEMICOL  { $$ = $1; yyerrok; }
 
     expression_statement
-        : SEMICOL               { }
+        : SEMICOL               { $$ = driver.getAST()->createNode<BlockStatement>(@$); }
         | expression SEMICOL    { $$ = driver.getAST()->createNode<ExpressionStatement>(@$, $1); }
 
     selection_statement
@@ -237,9 +244,16 @@
         | BREAK SEMICOL     { $$ = driver.getAST()->createNode<BreakStatement>(@$); }
 
     translation_unit
-        : statement_list { $$ = $1; driver.getAST()->setRoot($1); }
+        : top_statement_list { $$ = $1; driver.getAST()->setRoot($1); }
+
+    // Same as statement_list, but every statement goes through the driver
+    // as soon as it is reduced, so that a streamed program can run it.
+    top_statement_list
+        : statement                         { $$ = driver.addStatement(nullptr, $1, @$); }
+        | top_statement_list statement      { $$ = driver.addStatement($1, $2, @$); }
+        | top_statement_list error SEMICOL  { $$ = $1; yyerrok; }
 %%
 
-void paracl::frontend::Parser::error(const location& loc, const std::string& msg) {
+void paracl::frontend::Parser::error(const location_type& loc, const std::string& msg) {
     driver.getReporter()->reportError<Syntax>(loc, msg);
 }
@@ -0,0 +1,432 @@
+#include <bit>
+#include <array>
+#include <string>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+#include <string_view>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "frontend/Scanner.hpp"
+#include "frontend/Driver.hpp"
+#include "frontend/Errors.hpp"
+
+namespace paracl::frontend
+{
+
+namespace
+{
+
+using Token = Parser::token;
+
+enum CharClass : uint8_t
+{
+    SPACE = 1 << 0,
+    LETTER = 1 << 1,
+    DIGIT = 1 << 2,
+    PUNCT = 1 << 3,
+    NUL = 1 << 4,
+};
+
+constexpr std::array<uint8_t, 256> charClasses = [] {
+    std::array<uint8_t, 256> classes{};
+    for (unsigned char c: std::string_view{" \t\r\n"}) {
+        classes[c] = SPACE;
+    }
+    for (int c = 'a'; c <= 'z'; ++c) {
+        classes[c] = LETTER;
+        classes[c - 'a' + 'A'] = LETTER;
+    }
+    classes['_'] = LETTER;
+    for (int c = '0'; c <= '9'; ++c) {
+        classes[c] = DIGIT;
+    }
+    for (unsigned char c: std::string_view{"+-*/%<>=!&|;,:?()[]{}"}) {
+        classes[c] = PUNCT;
+    }
+    classes[0] = NUL;
+    return classes;
+}();
+
+uint8_t classOf(char c) {
+    return charClasses[static_cast<unsigned char>(c)];
+}
+
+// Punctuators of one character; TOKEN_EOF for `&` and `|`, which only
+// come in pairs.
+constexpr std::array<Parser::token_type, 256> singles = [] {
+    std::array<Parser::token_type, 256> tokens{};
+    tokens['+'] = Token::TOKEN_ADD_OP;
+    tokens['-'] = Token::TOKEN_SUB_OP;
+    tokens['*'] = Token::TOKEN_MUL_OP;
+    tokens['/'] = Token::TOKEN_DIV_OP;
+    tokens['%'] = Token::TOKEN_MOD_OP;
+    tokens['<'] = Token::TOKEN_L_OP;
+    tokens['>'] = Token::TOKEN_G_OP;
+    tokens['='] = Token::TOKEN_ASSIGN;
+    tokens['!'] = Token::TOKEN_NOT_OP;
+    tokens[';'] = Token::TOKEN_SEMICOL;
+    tokens[','] = Token::TOKEN_COMMA;
+    tokens[':'] = Token::TOKEN_COLON;
+    tokens['?'] = Token::TOKEN_QMARK;
+    tokens['('] = Token::TOKEN_LPAREN;
+    tokens[')'] = Token::TOKEN_RPAREN;
+    tokens['['] = Token::TOKEN_LSQUARE;
+    tokens[']'] = Token::TOKEN_RSQUARE;
+    tokens['{'] = Token::TOKEN_LCURLY;
+    tokens['}'] = Token::TOKEN_RCURLY;
+    return tokens;
+}();
+
+// Punctuators of two characters by their first one, TOKEN_EOF if there
+// are none.
+Parser::token_type pairOf(char first, char second) {
+    switch (first) {
+    case '+':
+        return second == '+' ? Token::TOKEN_INC_OP : Token::TOKEN_EOF;
+    case '-':
+        return second == '-' ? Token::TOKEN_DEC_OP : Token::TOKEN_EOF;
+    case '&':
+        return second == '&' ? Token::TOKEN_AND_OP : Token::TOKEN_EOF;
+    case '|':
+        return second == '|' ? Token::TOKEN_OR_OP : Token::TOKEN_EOF;
+    case '<':
+        return second == '=' ? Token::TOKEN_LE_OP : Token::TOKEN_EOF;
+    case '>':
+        return second == '=' ? Token::TOKEN_GE_OP : Token::TOKEN_EOF;
+    case '=':
+        return second == '=' ? Token::TOKEN_EQ_OP : Token::TOKEN_EOF;
+    case '!':
+        return second == '=' ? Token::TOKEN_NE_OP : Token::TOKEN_EOF;
+    default:
+        return Token::TOKEN_EOF;
+    }
+}
+
+struct Keyword
+{
+    std::string_view name_;
+    Parser::token_type token_ = Token::TOKEN_EOF;
+};
+
+constexpr Keyword keywords[] = {
+    {"break", Token::TOKEN_BREAK},
+    {"continue", Token::TOKEN_CONTINUE},
+    {"do", Token::TOKEN_DO},
+    {"else", Token::TOKEN_ELSE},
+    {"for", Token::TOKEN_FOR},
+    {"if", Token::TOKEN_IF},
+    {"int", Token::TOKEN_INT},
+    {"print", Token::TOKEN_PRINT},
+    {"while", Token::TOKEN_WHILE},
+};
+
+constexpr size_t minKeyword = 2;
+constexpr size_t maxKeyword = 8;
+
+// First and last character and length: distinct for every keyword, as
+// checked below, so a name is a keyword iff it equals the one in its slot.
+constexpr size_t keywordHash(std::string_view name) {
+    return (static_cast<unsigned char>(name.front()) + static_cast<unsigned char>(name.back()) * 8u + name.size()) & 15u;
+}
+
+constexpr std::array<Keyword, 16> keywordTable = [] {
+    std::array<Keyword, 16> table{};
+    for (const Keyword& keyword: keywords) {
+        table[keywordHash(keyword.name_)] = keyword;
+    }
+    return table;
+}();
+
+constexpr bool isPerfect() {
+    for (const Keyword& keyword: keywords) {
+        if (keywordTable[keywordHash(keyword.name_)].name_ != keyword.name_) {
+            return false;
+        }
+        if (keyword.name_.size() < minKeyword || keyword.name_.size() > maxKeyword) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(isPerfect(), "keyword hash has collisions");
+
+Parser::token_type keywordOf(std::string_view name) {
+    if (name.size() < minKeyword || name.size() > maxKeyword) {
+        return Token::TOKEN_EOF;
+    }
+    const Keyword& keyword = keywordTable[keywordHash(name)];
+    return keyword.name_ == name ? keyword.token_ : Token::TOKEN_EOF;
+}
+
+#if defined(__AVX2__) || defined(__SSE2__)
+#define PARACL_SCANNER_SIMD 1
+
+// One load of blockSize characters, compared against a character at a
+// time; bit i of a mask is character i.
+#if defined(__AVX2__)
+constexpr size_t blockSize = 32;
+
+struct Block
+{
+    __m256i bytes_;
+
+    explicit Block(const char* text)
+    : bytes_(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(text))) {}
+
+    uint32_t equal(char c) const {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes_, _mm256_set1_epi8(c))));
+    }
+};
+#else
+constexpr size_t blockSize = 16;
+
+struct Block
+{
+    __m128i bytes_;
+
+    explicit Block(const char* text)
+    : bytes_(_mm_loadu_si128(reinterpret_cast<const __m128i*>(text))) {}
+
+    uint32_t equal(char c) const {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes_, _mm_set1_epi8(c))));
+    }
+};
+#endif
+
+uint32_t below(unsigned count) {
+    return count >= 32 ? ~0u : (1u << count) - 1;
+}
+#endif
+
+} // namespace
+
+Scanner::Scanner(Driver& driver, LineIndex& lines, SourceBuffer& source)
+: driver_(driver), lines_(lines), text_(source.data()), end_(source.size()) {
+    if (source.size() > UINT32_MAX) {
+        throw std::runtime_error("source file is too large");
+    }
+}
+
+Scanner::Scanner(Driver& driver, LineIndex& lines, std::istream& in)
+: driver_(driver), lines_(lines), in_(std::addressof(in)), text_(buffer_.data()), end_(0) {}
+
+bool Scanner::more() {
+    if (!in_ || eof_) {
+        return false;
+    }
+    // Like the Flex scanner's refill: a statement must not wait for the
+    // next kilobytes of program text.
+    std::streambuf* buf = in_->rdbuf();
+    std::streamsize avail = buf->in_avail();
+    std::streamsize want = avail > 0 ? std::min<std::streamsize>(avail, 1 << 16) : 1;
+    size_t size = buffer_.size();
+    buffer_.resize(size + static_cast<size_t>(want));
+    std::streamsize got = buf->sgetn(buffer_.data() + size, want);
+    buffer_.resize(size + static_cast<size_t>(std::max<std::streamsize>(got, 0)));
+    text_ = buffer_.data();
+    end_ = buffer_.size();
+    if (got <= 0) {
+        eof_ = true;
+        return false;
+    }
+    return true;
+}
+
+void Scanner::compact() {
+    if (pos_ < 4096 || pos_ < buffer_.size() / 2) {
+        return;
+    }
+    buffer_.erase(0, pos_);
+    base_ += static_cast<uint32_t>(pos_);
+    pos_ = 0;
+    text_ = buffer_.data();
+    end_ = buffer_.size();
+}
+
+void Scanner::newLines(size_t pos, uint32_t mask) {
+    for (; mask; mask &= mask - 1) {
+        lines_.addLine(base_ + static_cast<uint32_t>(pos + std::countr_zero(mask)) + 1);
+    }
+}
+
+size_t Scanner::skipSpace(size_t pos) {
+    for (;;) {
+#ifdef PARACL_SCANNER_SIMD
+        while (pos + blockSize <= end_) {
+            Block block{text_ + pos};
+            uint32_t breaks = block.equal('\n');
+            uint32_t spaces = breaks | block.equal(' ') | block.equal('\t') | block.equal('\r');
+            auto run = static_cast<unsigned>(std::countr_one(spaces));
+            newLines(pos, breaks & below(run));
+            pos += run;
+            if (run < blockSize) {
+                return pos;
+            }
+        }
+#endif
+        for (char c; (c = text_[pos]), classOf(c) == SPACE; ++pos) {
+            if (c == '\n') {
+                lines_.addLine(base_ + static_cast<uint32_t>(pos) + 1);
+            }
+        }
+        if (pos < end_ || !more()) {
+            return pos;
+        }
+    }
+}
+
+size_t Scanner::skipLine(size_t pos) {
+    for (;;) {
+#ifdef PARACL_SCANNER_SIMD
+        while (pos + blockSize <= end_) {
+            if (uint32_t breaks = Block{text_ + pos}.equal('\n')) {
+                return pos + static_cast<size_t>(std::countr_zero(breaks));
+            }
+            pos += blockSize;
+        }
+#endif
+        while (pos < end_ && text_[pos] != '\n') {
+            ++pos;
+        }
+        if (pos < end_ || !more()) {
+            return pos;
+        }
+    }
+}
+
+bool Scanner::skipComment(size_t& pos) {
+    size_t begin = pos;
+    pos += 2;
+    for (;;) {
+#ifdef PARACL_SCANNER_SIMD
+        // Strictly inside the text, so the character after a `*` is there.
+        while (pos + blockSize < end_) {
+            Block block{text_ + pos};
+            uint32_t breaks = block.equal('\n');
+            for (uint32_t stars = block.equal('*'); stars; stars &= stars - 1) {
+                auto star = static_cast<unsigned>(std::countr_zero(stars));
+                if (text_[pos + star + 1] == '/') {
+                    newLines(pos, breaks & below(star));
+                    pos += star + 2;
+                    return true;
+                }
+            }
+            newLines(pos, breaks);
+            pos += blockSize;
+        }
+#endif
+        for (; pos < end_; ++pos) {
+            char c = text_[pos];
+            if (c == '\n') {
+                lines_.addLine(base_ + static_cast<uint32_t>(pos) + 1);
+            } else if (c == '*' && peek(pos + 1) == '/') {
+                pos += 2;
+                return true;
+            }
+        }
+        if (!more()) {
+            driver_.getReporter()->reportError<UnterminatedComment>(range(begin, pos));
+            return false;
+        }
+    }
+}
+
+Parser::symbol_type Scanner::identifier(size_t begin) {
+    size_t pos = begin + 1;
+    for (;;) {
+        while (classOf(text_[pos]) & (LETTER | DIGIT)) {
+            ++pos;
+        }
+        if (pos < end_ || !more()) {
+            break;
+        }
+    }
+    pos_ = pos;
+    std::string_view name{text_ + begin, pos - begin};
+    if (Parser::token_type keyword = keywordOf(name); keyword != Token::TOKEN_EOF) {
+        return Parser::symbol_type{keyword, range(begin, pos)};
+    }
+    return Parser::make_IDENTIFIER(driver_.getInterner()->intern(name), range(begin, pos));
+}
+
+// `0|[1-9][0-9]*`, wrapping around like std::atoi on the values that fit
+// its long.
+Parser::symbol_type Scanner::constant(size_t begin) {
+    size_t pos = begin + 1;
+    uint32_t value = static_cast<uint32_t>(text_[begin] - '0');
+    if (value != 0) {
+        for (;;) {
+            for (char c; (c = text_[pos]), classOf(c) == DIGIT; ++pos) {
+                value = value * 10 + static_cast<uint32_t>(c - '0');
+            }
+            if (pos < end_ || !more()) {
+                break;
+            }
+        }
+    }
+    pos_ = pos;
+    return Parser::make_CONSTANT(static_cast<int>(value), range(begin, pos));
+}
+
+Parser::symbol_type Scanner::getNextToken() {
+    if (in_) {
+        compact();
+    }
+    size_t pos = pos_;
+    for (;;) {
+        pos = skipSpace(pos);
+        char c = text_[pos];
+        switch (classOf(c)) {
+        case LETTER:
+            return identifier(pos);
+        case DIGIT:
+            return constant(pos);
+        case PUNCT: {
+            char next = peek(pos + 1);
+            if (c == '/' && next == '/') {
+                pos = skipLine(pos + 2);
+                continue;
+            }
+            if (c == '/' && next == '*') {
+                if (!skipComment(pos)) {
+                    pos_ = pos;
+                    return Parser::make_EOF(range(pos, pos));
+                }
+                continue;
+            }
+            if (Parser::token_type token = pairOf(c, next); token != Token::TOKEN_EOF) {
+                pos_ = pos + 2;
+                return Parser::symbol_type{token, range(pos, pos + 2)};
+            }
+            if (Parser::token_type token = singles[static_cast<unsigned char>(c)]; token != Token::TOKEN_EOF) {
+                pos_ = pos + 1;
+                return Parser::symbol_type{token, range(pos, pos + 1)};
+            }
+            break;
+        }
+        case NUL:
+            if (pos == end_) {
+                pos_ = pos;
+                return Parser::make_EOF(range(pos, pos));
+            }
+            break;
+        default:
+            break;
+        }
+        driver_.getReporter()->reportError<UnknownToken>(range(pos, pos + 1), std::string(1, c));
+        ++pos;
+    }
+}
+
+bool Scanner::pending() {
+    return pos_ < end_ || (in_ && !eof_ && in_->rdbuf()->in_avail() > 0);
+}
+
+} // namespace paracl::frontend
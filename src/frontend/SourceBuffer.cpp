@@ -0,0 +1,58 @@
+#include <iterator>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "frontend/SourceBuffer.hpp"
+
+namespace paracl::frontend
+{
+
+SourceBuffer::SourceBuffer(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("can not open " + path);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error("can not open " + path);
+    }
+    size_ = static_cast<size_t>(st.st_size);
+
+    // Anonymous zero pages with the file mapped over their start: the
+    // rest of the file's last page reads as zeros, and so does the spare
+    // page when the file ends on a page boundary.
+    size_t page = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    mapped_ = (size_ + 2 + page - 1) / page * page;
+    void* memory = ::mmap(nullptr, mapped_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) {
+        ::close(fd);
+        throw std::runtime_error("can not map " + path);
+    }
+    if (size_ != 0 && ::mmap(memory, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        ::munmap(memory, mapped_);
+        ::close(fd);
+        throw std::runtime_error("can not map " + path);
+    }
+    ::close(fd);
+    data_ = static_cast<char*>(memory);
+}
+
+SourceBuffer::SourceBuffer(std::istream& in)
+: text_(std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}) {
+    size_ = text_.size();
+    text_.append(2, '\0');
+    data_ = text_.data();
+}
+
+SourceBuffer::~SourceBuffer() {
+    if (mapped_ != 0) {
+        ::munmap(data_, mapped_);
+    }
+}
+
+} // namespace paracl::frontend
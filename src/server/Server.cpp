@@ -0,0 +1,387 @@
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+#include <streambuf>
+#include <stdexcept>
+
+#include <unistd.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+
+#include "server/Server.hpp"
+#include "frontend/Driver.hpp"
+#include "backend/VM.hpp"
+#include "support/ThreadPool.hpp"
+
+namespace paracl::server
+{
+
+namespace
+{
+
+constexpr char magic[4] = {'P', 'C', 'L', '1'};
+
+std::string systemError(const std::string& what) {
+    return what + ": " + std::strerror(errno);
+}
+
+void sendAll(int fd, const char* data, size_t size) {
+    while (size != 0) {
+        ssize_t sent = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::runtime_error(systemError("can not send"));
+        }
+        data += sent;
+        size -= static_cast<size_t>(sent);
+    }
+}
+
+// False when the peer closes the connection or the receive times out.
+bool receiveAll(int fd, char* data, size_t size) {
+    while (size != 0) {
+        ssize_t got = ::recv(fd, data, size, 0);
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        if (got <= 0) {
+            return false;
+        }
+        data += got;
+        size -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+void sendFrame(int fd, char kind, std::string_view payload) {
+    char header[5];
+    auto size = static_cast<uint32_t>(payload.size());
+    header[0] = kind;
+    std::memcpy(header + 1, &size, sizeof(size));
+    sendAll(fd, header, sizeof(header));
+    sendAll(fd, payload.data(), payload.size());
+}
+
+// Turns every write of the program's Output into an 'O' frame. A failed
+// send leaves the stream bad, which the Output reports.
+class FrameBuffer final : public std::streambuf
+{
+private:
+    int fd_;
+
+protected:
+    std::streamsize xsputn(const char* data, std::streamsize size) override {
+        sendFrame(fd_, 'O', std::string_view{data, static_cast<size_t>(size)});
+        return size;
+    }
+
+    int_type overflow(int_type c) override {
+        if (traits_type::eq_int_type(c, traits_type::eof())) {
+            return traits_type::not_eof(c);
+        }
+        char ch = traits_type::to_char_type(c);
+        sendFrame(fd_, 'O', std::string_view{&ch, 1});
+        return c;
+    }
+
+public:
+    explicit FrameBuffer(int fd)
+    : fd_(fd) {}
+};
+
+// Arms the watchdog for the lifetime of one run.
+class Deadline final
+{
+private:
+    Watchdog& watchdog_;
+    Watchdog::Clock::time_point deadline_;
+    std::atomic<bool> expired_{false};
+
+public:
+    Deadline(Watchdog& watchdog, std::chrono::milliseconds limit)
+    : watchdog_(watchdog), deadline_(Watchdog::Clock::now() + limit) {
+        watchdog_.arm(deadline_, &expired_);
+    }
+
+    Deadline(const Deadline&) = delete;
+    Deadline& operator=(const Deadline&) = delete;
+
+    ~Deadline() {
+        watchdog_.disarm(deadline_, &expired_);
+    }
+
+    const std::atomic<bool>* flag() const {
+        return &expired_;
+    }
+};
+
+sockaddr_un socketAddress(const std::string& path) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        throw std::runtime_error("socket path is too long: " + path);
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+    return address;
+}
+
+} // namespace
+
+std::shared_ptr<const backend::Program> ProgramCache::find(const std::string& source) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto found = index_.find(source);
+    if (found == index_.end()) {
+        return nullptr;
+    }
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return found->second->second;
+}
+
+void ProgramCache::insert(const std::string& source, std::shared_ptr<const backend::Program> program) {
+    if (capacity_ == 0) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock{mutex_};
+    // Another worker may have compiled the same program meanwhile.
+    if (index_.count(source)) {
+        return;
+    }
+    if (entries_.size() == capacity_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    entries_.emplace_front(source, std::move(program));
+    index_.emplace(entries_.front().first, entries_.begin());
+}
+
+Watchdog::~Watchdog() {
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        stop_ = true;
+    }
+    wake_.notify_one();
+    thread_.join();
+}
+
+void Watchdog::watch() {
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (!stop_) {
+        if (deadlines_.empty()) {
+            wake_.wait(lock);
+            continue;
+        }
+        auto now = Clock::now();
+        auto first = deadlines_.begin();
+        if (first->first > now) {
+            wake_.wait_until(lock, first->first);
+            continue;
+        }
+        auto last = deadlines_.upper_bound(now);
+        for (auto it = first; it != last; ++it) {
+            it->second->store(true, std::memory_order_relaxed);
+        }
+        deadlines_.erase(first, last);
+    }
+}
+
+void Watchdog::arm(Clock::time_point deadline, std::atomic<bool>* flag) {
+    bool earliest;
+    {
+        std::lock_guard<std::mutex> lock{mutex_};
+        auto armed = deadlines_.emplace(deadline, flag);
+        earliest = armed == deadlines_.begin();
+    }
+    if (earliest) {
+        wake_.notify_one();
+    }
+}
+
+void Watchdog::disarm(Clock::time_point deadline, std::atomic<bool>* flag) {
+    std::lock_guard<std::mutex> lock{mutex_};
+    auto [first, last] = deadlines_.equal_range(deadline);
+    for (auto it = first; it != last; ++it) {
+        if (it->second == flag) {
+            deadlines_.erase(it);
+            return;
+        }
+    }
+}
+
+std::shared_ptr<const backend::Program> Server::compile(const std::string& source, std::ostream& diagnostics,
+                                                        const std::atomic<bool>* interrupt) {
+    if (auto cached = cache_.find(source)) {
+        return cached;
+    }
+    std::istringstream in{source};
+    frontend::Driver drv{"<request>", in};
+    drv.interruptOn(interrupt);
+    drv.getParser()->parse();
+    frontend::AST* ast = drv.getAST();
+    if (ast->getRoot() != nullptr) {
+        ast->semanticAnalyze(drv);
+    }
+    if (drv.getReporter()->hasErrors()) {
+        drv.getReporter()->reportAllErrors(diagnostics);
+        return nullptr;
+    }
+    if (options_.optimize_) {
+        ast->optimize();
+        drv.checkInterrupt();
+    }
+    auto program = std::make_shared<backend::Program>();
+    ast->compile(*program, options_.limits_.memory_);
+    drv.checkInterrupt();
+    cache_.insert(source, program);
+    return program;
+}
+
+void Server::execute(const backend::Program& program, const std::string& input, int fd,
+                     const std::atomic<bool>* interrupt) {
+    std::istringstream in{input};
+    FrameBuffer frames{fd};
+    std::ostream out{&frames};
+    backend::Executer executer{in, out};
+    executer.enableJit(options_.jit_);
+    executer.interruptOn(interrupt);
+    executer.run(program.view());
+}
+
+void Server::serve(int fd) {
+    std::ostringstream diagnostics;
+    int32_t status = 1;
+    try {
+        char header[12];
+        uint32_t sizes[2];
+        if (!receiveAll(fd, header, sizeof(header)) || std::memcmp(header, magic, sizeof(magic)) != 0) {
+            throw std::runtime_error("malformed request");
+        }
+        std::memcpy(sizes, header + sizeof(magic), sizeof(sizes));
+        if (size_t{sizes[0]} + sizes[1] > options_.limits_.memory_) {
+            throw std::runtime_error("memory limit exceeded");
+        }
+        std::string source(sizes[0], '\0');
+        std::string input(sizes[1], '\0');
+        if (!receiveAll(fd, source.data(), source.size()) || !receiveAll(fd, input.data(), input.size())) {
+            throw std::runtime_error("malformed request");
+        }
+        // One deadline covers compiling and running.
+        Deadline deadline{watchdog_, options_.limits_.time_};
+        if (auto program = compile(source, diagnostics, deadline.flag())) {
+            execute(*program, input, fd, deadline.flag());
+            status = 0;
+        }
+    } catch (const std::exception& e) {
+        diagnostics << e.what() << '\n';
+    }
+    // The client may be gone already.
+    try {
+        std::string text = diagnostics.str();
+        if (!text.empty()) {
+            sendFrame(fd, 'E', text);
+        }
+        sendFrame(fd, 'S', std::string_view{reinterpret_cast<const char*>(&status), sizeof(status)});
+    } catch (const std::exception& ) {}
+    ::close(fd);
+}
+
+void Server::run() {
+    sockaddr_un address = socketAddress(options_.socketPath_);
+    int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        throw std::runtime_error(systemError("can not create socket"));
+    }
+    // A socket file left behind by an earlier server; any other file is
+    // not ours to remove.
+    struct stat st;
+    if (::lstat(options_.socketPath_.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            ::close(listener);
+            throw std::runtime_error("can not listen on " + options_.socketPath_ + ": not a socket");
+        }
+        ::unlink(options_.socketPath_.c_str());
+    }
+    if (::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listener, SOMAXCONN) < 0) {
+        std::string error = systemError("can not listen on " + options_.socketPath_);
+        ::close(listener);
+        throw std::runtime_error(error);
+    }
+    // A client that stalls mid-request or stops reading the output gives
+    // up its worker after the time limit.
+    auto limit = std::chrono::duration_cast<std::chrono::microseconds>(options_.limits_.time_);
+    timeval timeout{static_cast<time_t>(limit.count() / 1000000), static_cast<suseconds_t>(limit.count() % 1000000)};
+    support::ThreadPool pool{options_.workers_};
+    for (;;) {
+        int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            throw std::runtime_error(systemError("can not accept"));
+        }
+        ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        pool.submit([this, fd] { serve(fd); });
+    }
+}
+
+int request(const std::string& socketPath, std::string_view program, std::string_view input,
+            std::ostream& out, std::ostream& err) {
+    sockaddr_un address = socketAddress(socketPath);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        throw std::runtime_error(systemError("can not create socket"));
+    }
+    int32_t status = -1;
+    try {
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            throw std::runtime_error(systemError("can not connect to " + socketPath));
+        }
+        char header[12];
+        uint32_t sizes[2] = {static_cast<uint32_t>(program.size()), static_cast<uint32_t>(input.size())};
+        std::memcpy(header, magic, sizeof(magic));
+        std::memcpy(header + sizeof(magic), sizes, sizeof(sizes));
+        // The server stops reading a request it rejects, but still says why.
+        std::string sendError;
+        try {
+            sendAll(fd, header, sizeof(header));
+            sendAll(fd, program.data(), program.size());
+            sendAll(fd, input.data(), input.size());
+            ::shutdown(fd, SHUT_WR);
+        } catch (const std::exception& e) {
+            sendError = e.what();
+        }
+
+        std::string payload;
+        char frame[5];
+        while (receiveAll(fd, frame, sizeof(frame))) {
+            uint32_t size;
+            std::memcpy(&size, frame + 1, sizeof(size));
+            payload.resize(size);
+            if (!receiveAll(fd, payload.data(), size)) {
+                break;
+            }
+            if (frame[0] == 'O') {
+                out << payload;
+            } else if (frame[0] == 'E') {
+                err << payload;
+            } else if (frame[0] == 'S' && size == sizeof(status)) {
+                std::memcpy(&status, payload.data(), sizeof(status));
+            }
+        }
+        if (status < 0) {
+            throw std::runtime_error(sendError.empty() ? "connection closed by the server" : sendError);
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    return status;
+}
+
+} // namespace paracl::server
@@ -0,0 +1,54 @@
+# Runs one sample program in one execution mode and compares its output.
+#   cmake -DPARACL=<paracl> -DPROGRAM=<name.cl> -DMODE=<mode> -P RunProgram.cmake
+# name.in is fed to `?`, name.out is the expected stdout. With a name.err
+# the run must fail with that text on stderr.
+
+get_filename_component(dir ${PROGRAM} DIRECTORY)
+get_filename_component(name ${PROGRAM} NAME_WE)
+set(base ${dir}/${name})
+
+if (MODE STREQUAL "default")
+    set(flags "")
+elseif (MODE STREQUAL "no-jit")
+    set(flags --no-jit)
+elseif (MODE STREQUAL "no-optimize")
+    set(flags --no-optimize)
+elseif (MODE STREQUAL "stream")
+    set(flags --stream)
+elseif (MODE STREQUAL "llvm")
+    set(flags --llvm)
+else ()
+    message(FATAL_ERROR "unknown mode ${MODE}")
+endif ()
+
+set(input /dev/null)
+if (EXISTS ${base}.in)
+    set(input ${base}.in)
+endif ()
+
+execute_process(
+    COMMAND ${PARACL} ${flags} ${PROGRAM}
+    INPUT_FILE ${input}
+    OUTPUT_VARIABLE output
+    ERROR_VARIABLE errors
+    RESULT_VARIABLE status
+    TIMEOUT 60
+)
+
+file(READ ${base}.out expected)
+if (NOT output STREQUAL expected)
+    message(FATAL_ERROR "${name} (${MODE}): output differs\n--- expected\n${expected}--- got\n${output}--- stderr\n${errors}")
+endif ()
+
+if (EXISTS ${base}.err)
+    file(STRINGS ${base}.err diagnostic LIMIT_COUNT 1)
+    if (status EQUAL 0)
+        message(FATAL_ERROR "${name} (${MODE}): expected to fail")
+    endif ()
+    string(FIND "${errors}" "${diagnostic}" found)
+    if (found EQUAL -1)
+        message(FATAL_ERROR "${name} (${MODE}): expected '${diagnostic}' on stderr, got\n${errors}")
+    endif ()
+elseif (NOT status EQUAL 0)
+    message(FATAL_ERROR "${name} (${MODE}): exited with ${status}\n${errors}")
+endif ()
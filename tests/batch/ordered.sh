@@ -0,0 +1,24 @@
+#!/bin/sh
+# Usage: ordered.sh <paracl>
+# Checks programs on several workers, the later ones finishing first, and
+# expects their diagnostics in the order of the command line.
+paracl=$1
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+inputs=
+for i in $(seq 8); do
+    # Earlier inputs are longer, so they tend to finish last.
+    seq $(( (9 - i) * 2000 )) | sed 's/.*/x = &;/' >"$dir/p$i.cl"
+    echo "print v$i;" >>"$dir/p$i.cl"
+    inputs="$inputs $dir/p$i.cl"
+done
+
+"$paracl" --check --jobs 4 $inputs 2>"$dir/err"
+status=$?
+order=$(grep -o "'v[0-9]*'" "$dir/err" | tr -d "'\n")
+if [ $status -eq 0 ] || [ "$order" != v1v2v3v4v5v6v7v8 ]; then
+    echo "expected the errors of v1..v8 in order, got status $status:"
+    cat "$dir/err"
+    exit 1
+fi
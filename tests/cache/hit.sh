@@ -0,0 +1,44 @@
+#!/bin/sh
+# Usage: hit.sh <paracl> <program.cl> <expected.out>
+# Runs the program twice on one cache directory and expects the second
+# run to skip parsing and print the same output. A damaged entry must
+# count as a miss and be replaced.
+paracl=$1
+program=$2
+expected=$3
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+# run <name>: runs the program with --stats, checks the output.
+run() {
+    "$paracl" --cache-dir "$dir/cache" --stats "$program" </dev/null >"$dir/$1.out" 2>"$dir/$1.err" || {
+        echo "$1 run failed:"
+        cat "$dir/$1.err"
+        exit 1
+    }
+    if ! cmp -s "$dir/$1.out" "$expected"; then
+        echo "$1 run printed:"
+        cat "$dir/$1.out"
+        exit 1
+    fi
+}
+
+run miss
+grep -q "^parse " "$dir/miss.err" || { echo "the first run did not compile"; exit 1; }
+[ -n "$(find "$dir/cache" -name '*.pclb')" ] || { echo "nothing was stored"; exit 1; }
+
+run hit
+if grep -q "^parse " "$dir/hit.err"; then
+    echo "the second run compiled again"
+    exit 1
+fi
+
+entry=$(find "$dir/cache" -name '*.pclb')
+printf 'XXXX' | dd of="$entry" bs=1 seek=0 conv=notrunc 2>/dev/null
+run damaged
+grep -q "^parse " "$dir/damaged.err" || { echo "a damaged entry was used"; exit 1; }
+run repaired
+if grep -q "^parse " "$dir/repaired.err"; then
+    echo "the damaged entry was not replaced"
+    exit 1
+fi
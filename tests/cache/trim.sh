@@ -0,0 +1,26 @@
+#!/bin/sh
+# Usage: trim.sh <paracl> <program.cl>
+# Compiles the program into a 1 MiB cache that also holds a large foreign
+# file and two temporary files, and expects only the stale temporary file
+# to go: foreign files neither count nor get evicted.
+paracl=$1
+program=$2
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+head -c 3000000 /dev/zero >"$dir/notes.bin"
+echo >"$dir/fresh.pclb.tmp1"
+echo >"$dir/stale.pclb.tmp2"
+touch -d '3 hours ago' "$dir/stale.pclb.tmp2"
+
+"$paracl" --cache-dir "$dir" --cache-size 1 "$program" </dev/null >/dev/null || exit 1
+
+fail() {
+    echo "$1"
+    ls -l "$dir"
+    exit 1
+}
+[ -n "$(find "$dir" -name '*.pclb')" ] || fail "the entry was evicted"
+[ -f "$dir/notes.bin" ] || fail "a foreign file was evicted"
+[ -f "$dir/fresh.pclb.tmp1" ] || fail "a temporary file in flight was removed"
+[ ! -f "$dir/stale.pclb.tmp2" ] || fail "a stale temporary file was kept"
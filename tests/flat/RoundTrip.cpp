@@ -0,0 +1,172 @@
+#include <string>
+#include <vector>
+#include <utility>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "frontend/Driver.hpp"
+#include "frontend/NodeTraversal.hpp"
+
+using namespace paracl::frontend;
+
+namespace
+{
+
+// Walks the pointer tree and the flat one side by side: every node must
+// keep its kind, location, operation and operands, every block its
+// statements in order, and every break and continue the id of its loop.
+class RoundTrip
+{
+private:
+    const FlatAST& flat_;
+    std::vector<std::pair<INode*, NodeId>> pending_;
+    std::unordered_map<const WhileStatement*, NodeId> loops_;
+    std::vector<std::pair<NodeId, const WhileStatement*>> jumps_;
+
+    static void expect(bool ok, NodeId id, const char* what) {
+        if (!ok) {
+            throw std::runtime_error("node " + std::to_string(id) + ": " + what);
+        }
+    }
+
+    // Children are flattened first, so their ids are smaller.
+    void child(INode* node, NodeId parent, NodeId id) {
+        expect(id < parent, parent, "child after its parent");
+        pending_.emplace_back(node, id);
+    }
+
+    void compare(INode* node, NodeId id) {
+        expect(id < flat_.size(), id, "id out of range");
+        expect(flat_.kind(id) == node->kind_, id, "kind");
+        expect(flat_.loc(id).begin == node->loc_.begin && flat_.loc(id).end == node->loc_.end, id, "location");
+        switch (node->kind_) {
+        case NodeKind::UNARY_EXPRESSION: {
+            auto unary = static_cast<UnaryExpression*>(node);
+            expect(flat_.unaryOp(id) == unary->op_, id, "unary operation");
+            child(unary->expr_, id, flat_.operand(id, 0));
+            return;
+        }
+        case NodeKind::BINARY_EXPRESSION: {
+            auto binary = static_cast<BinaryExpression*>(node);
+            expect(flat_.binaryOp(id) == binary->op_, id, "binary operation");
+            child(binary->left_, id, flat_.operand(id, 0));
+            child(binary->right_, id, flat_.operand(id, 1));
+            return;
+        }
+        case NodeKind::TERNARY_EXPRESSION: {
+            auto ternary = static_cast<TernaryExpression*>(node);
+            child(ternary->condition_, id, flat_.operand(id, 0));
+            child(ternary->onTrue_, id, flat_.operand(id, 1));
+            child(ternary->onFalse_, id, flat_.operand(id, 2));
+            return;
+        }
+        case NodeKind::CONSTANT_EXPRESSION:
+            expect(flat_.value(id) == static_cast<ConstantExpression*>(node)->value_, id, "constant");
+            return;
+        case NodeKind::VARIABLE_EXPRESSION: {
+            auto variable = static_cast<VariableExpression*>(node);
+            expect(flat_.name(id) == variable->name_ && flat_.depth(id) == variable->depth_
+                   && flat_.slot(id) == variable->slot_, id, "variable");
+            return;
+        }
+        case NodeKind::INPUT_EXPRESSION:
+            return;
+        case NodeKind::BLOCK_STATEMENT: {
+            auto block = static_cast<BlockStatement*>(node);
+            auto statements = flat_.statements(id);
+            expect(statements.size() == block->statements_.size(), id, "block size");
+            expect(flat_.declared(id) == block->table_.size(), id, "declared variables");
+            size_t i = 0;
+            for (auto statement: block->statements_) {
+                child(statement, id, statements[i++]);
+            }
+            return;
+        }
+        case NodeKind::EXPRESSION_STATEMENT:
+            child(static_cast<ExpressionStatement*>(node)->expr_, id, flat_.operand(id, 0));
+            return;
+        case NodeKind::IF_STATEMENT: {
+            auto stat = static_cast<IfStatement*>(node);
+            child(stat->condition_, id, flat_.operand(id, 0));
+            child(stat->trueBlock_, id, flat_.operand(id, 1));
+            return;
+        }
+        case NodeKind::IF_ELSE_STATEMENT: {
+            auto stat = static_cast<IfElseStatement*>(node);
+            child(stat->condition_, id, flat_.operand(id, 0));
+            child(stat->trueBlock_, id, flat_.operand(id, 1));
+            child(stat->falseBlock_, id, flat_.operand(id, 2));
+            return;
+        }
+        case NodeKind::WHILE_STATEMENT: {
+            auto stat = static_cast<WhileStatement*>(node);
+            loops_.emplace(stat, id);
+            child(stat->condition_, id, flat_.operand(id, 0));
+            child(stat->block_, id, flat_.operand(id, 1));
+            return;
+        }
+        case NodeKind::OUTPUT_STATEMENT:
+            child(static_cast<OutputStatement*>(node)->expr_, id, flat_.operand(id, 0));
+            return;
+        case NodeKind::BREAK_STATEMENT:
+            jumps_.emplace_back(id, static_cast<BreakStatement*>(node)->whileStat);
+            return;
+        case NodeKind::CONTINUE_STATEMENT:
+            jumps_.emplace_back(id, static_cast<ContinueStatement*>(node)->whileStat);
+            return;
+        }
+    }
+
+public:
+    explicit RoundTrip(const FlatAST& flat)
+    : flat_(flat) {}
+
+    // Returns the number of nodes compared.
+    size_t check(INode* root) {
+        expect(flat_.root() != noNode, 0, "empty flat tree");
+        pending_.emplace_back(root, flat_.root());
+        size_t nodes = 0;
+        while (!pending_.empty()) {
+            auto [node, id] = pending_.back();
+            pending_.pop_back();
+            compare(node, id);
+            ++nodes;
+        }
+        expect(nodes == flat_.size(), flat_.root(), "node count");
+        for (auto [jump, loop]: jumps_) {
+            expect(loops_.count(loop) && flat_.operand(jump, 0) == loops_.at(loop), jump, "loop link");
+        }
+        return nodes;
+    }
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " <program.cl>..." << std::endl;
+        return 1;
+    }
+    int status = 0;
+    for (int i = 1; i < argc; ++i) {
+        try {
+            Driver drv{argv[i]};
+            drv.getParser()->parse();
+            AST& ast = *drv.getAST();
+            ast.semanticAnalyze(drv);
+            if (drv.getReporter()->hasErrors()) {
+                drv.getReporter()->reportAllErrors(std::cerr);
+                status = 1;
+                continue;
+            }
+            FlatAST flat = ast.flatten();
+            size_t nodes = RoundTrip{flat}.check(ast.getRoot());
+            std::cout << argv[i] << ": " << nodes << " nodes" << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << argv[i] << ": " << e.what() << std::endl;
+            status = 1;
+        }
+    }
+    return status;
+}
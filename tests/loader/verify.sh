@@ -0,0 +1,53 @@
+#!/bin/sh
+# Usage: verify.sh <paracl>
+# Compiles a small program to bytecode, damages copies of it in the ways
+# the loader must catch and expects each to be rejected before it runs.
+# A file without the magic is taken for source text; a damaged magic is
+# covered by the cache test.
+paracl=$1
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+printf 'x = 5;\nprint x;\n' >"$dir/program.cl"
+"$paracl" --emit-bytecode "$dir/good.pclb" "$dir/program.cl" || exit 1
+if [ "$("$paracl" "$dir/good.pclb")" != 5 ]; then
+    echo "the undamaged bytecode does not run"
+    exit 1
+fi
+
+# damage <name> <offset> <octal bytes>: overwrites bytes of a copy.
+damage() {
+    cp "$dir/good.pclb" "$dir/$1.pclb"
+    printf "$3" | dd of="$dir/$1.pclb" bs=1 seek="$2" conv=notrunc 2>/dev/null
+}
+
+# expect <name> <error>
+expect() {
+    "$paracl" "$dir/$1.pclb" >"$dir/out" 2>"$dir/err"
+    status=$?
+    if [ $status -eq 0 ] || ! grep -q "bytecode: $2" "$dir/err" || [ -s "$dir/out" ]; then
+        echo "$1: expected 'bytecode: $2', got status $status:"
+        cat "$dir/err"
+        exit 1
+    fi
+}
+
+head -c 16 "$dir/good.pclb" >"$dir/truncated.pclb"
+expect truncated "truncated header"
+
+damage version 4 '\143'
+expect version "unsupported version"
+
+damage order 8 '\001\002\003\004'
+expect order "foreign byte order"
+
+cp "$dir/good.pclb" "$dir/size.pclb"
+printf 'x' >>"$dir/size.pclb"
+expect size "section sizes do not match"
+
+# The first instruction starts right after the 32-byte header.
+damage opcode 32 '\377'
+expect opcode "unknown opcode at 0"
+
+damage operand 36 '\000\000\000\177'
+expect operand "operand out of range at 0"
@@ -0,0 +1,11 @@
+// 32-bit wrapping arithmetic, truncating division.
+big = 2147483647;
+print big + 1;
+print 0 - 7 / 2;
+print (0 - 7) % 3;
+print 7 % (0 - 3);
+min = 0 - 2147483647 - 1;
+print min / (0 - 1);
+print min % (0 - 1);
+print -min;
+print !0 + !5;
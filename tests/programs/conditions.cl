@@ -0,0 +1,16 @@
+// Conditions compile to fused compare-and-branch instructions.
+a = 3;
+b = 7;
+if (a < b && b < 10) print 1; else print 0;
+if (a > b || !(b != 7)) print 1; else print 0;
+if (!(a >= 3)) print 0; else print 1;
+if (10 > a) print 1;
+if (a <= 3 && 3 >= a && a == 3) print 1;
+x = a < b;
+y = a == b || b;
+print x + y;
+print a < b ? a : b;
+c = 0;
+while (c < 100 && !(c == 42))
+    c = c + 1;
+print c;
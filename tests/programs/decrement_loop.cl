@@ -0,0 +1,14 @@
+// A decrement at the end of a `&&` loop condition must not be fused with
+// the back-edge branch: the false exit of `&&` lands right after it.
+d = 0;
+l0 = 0;
+while (l0 < 3 && --d) {
+    l0 = l0 + 1;
+}
+print l0;
+print d;
+n = 3;
+while (--n) print n;
+k = 5;
+while (k > 2 && (k = k - 1)) print k;
+print k;
@@ -0,0 +1,4 @@
+print 1;
+zero = 0;
+print 10 / zero;
+print 2;
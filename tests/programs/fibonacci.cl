@@ -0,0 +1,11 @@
+// Fibonacci numbers, read how many from the input.
+fst = 0;
+snd = 1;
+iters = ?;
+while (iters > 0) {
+    tmp = fst;
+    fst = snd;
+    snd = snd + tmp;
+    iters = iters - 1;
+    print snd;
+}
@@ -0,0 +1,11 @@
+// Top-level statements the optimizer replaces or removes; with --stream
+// each one is the root of its own tree.
+if (1) print 7;
+1 + 2;
+x = 3;
+if (0) y = 1;
+print x + y;
+while (0) print 5;
+if (2 > 1) print 8; else print 9;
+(x, 4);
+print x ? 10 : 11;
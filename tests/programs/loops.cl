@@ -0,0 +1,25 @@
+// Nested loops with break and continue; hot enough for the JIT.
+total = 0;
+i = 0;
+while (i < 3000) {
+    i = i + 1;
+    if (i % 3 == 0)
+        continue;
+    j = 0;
+    while (1) {
+        j++;
+        if (j > 5)
+            break;
+        total = total + j;
+    }
+}
+print total;
+n = 5000;
+count = 0;
+while (--n)
+    count = count + 2;
+print count;
+k = 10;
+while (k = k - 1)
+    count = count - 1;
+print count;
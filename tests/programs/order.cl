@@ -0,0 +1,14 @@
+// Operands are evaluated left to right.
+x = 1;
+y = 1;
+z = 1;
+w = 0;
+print x + (x = 5);
+print y * (y = y + 1);
+print z + z++;
+if (w < (w = 0 - 1)) print 1; else print 0;
+v = 2;
+print v - (v = 10) * 0 + v;
+u = 1;
+print u < u++;
+print u;
@@ -0,0 +1,17 @@
+// Blocks open scopes; assignment declares in the innermost one.
+a = 1;
+{
+    a = 2;
+    b = 3;
+    {
+        c = a + b;
+        print c;
+    }
+}
+print a;
+i = 0;
+while (i < 3) {
+    t = i * i;
+    print t;
+    i++;
+}
@@ -0,0 +1,27 @@
+// `&&` and `||` with side effects in loop and branch conditions, and
+// unary plus on temporaries, in every position a condition compiles to.
+a = 0;
+b = 4;
+while (a < 10 && --b) a = a + 2;
+print a;
+print b;
+c = 0;
+d = 3;
+while (!(c > 5) && d--) c = c + 1;
+print c;
+print d;
+e = 0;
+f = 0;
+while (e++ < 3 || (f = f + 1) < 2) print e * 10 + f;
+g = 5;
+while ((g = g - 1) && g > 2) print g;
+print g;
+h = 2;
+if (h && --h) print 100; else print 200;
+if (h || ++h) print h;
+print (+(h + 1)) * (h + 2) ? +(h - 1) + (h * 3) : 7;
+k = 0;
+while (+(k + 1) < 4 && +(k * 2) < 10) k = k + 1;
+print k;
+m = 3;
+print (m > 0 && --m > 0) + (m || m++) + m;
@@ -0,0 +1,9 @@
+// Unary plus on a temporary keeps it live while the right operand is
+// evaluated.
+d = 4;
+print (+(d - 1)) + (d * 2);
+print (+(d - 1)) < (d + 10);
+if ((+(d - 1)) < (d + 10)) print 1;
+x = (+(d * 3)) - (+(d + 1)) * 2;
+print x;
+print +d + +(-d);
@@ -0,0 +1,37 @@
+#!/bin/sh
+# Usage: compile_limits.sh <paracl>
+# Sends large straight-line programs, which never reach a loop header, to
+# servers with a 1 ms time limit and with a 1 MiB memory limit, and
+# expects both limits to stop them while they compile.
+paracl=$1
+dir=$(mktemp -d)
+servers=
+trap 'kill $servers 2>/dev/null; rm -rf "$dir"' EXIT
+
+seq 100000 | sed 's/.*/x = x + &;/' >"$dir/long.cl"
+seq 100000 | sed 's/.*/print &;/' >"$dir/wide.cl"
+
+# expect <name> <server options> <program> <error>
+expect() {
+    socket=$dir/$1.sock
+    shift
+    options=$1
+    program=$2
+    error=$3
+    "$paracl" --serve "$socket" --jobs 1 $options &
+    servers="$servers $!"
+    for _ in $(seq 50); do
+        [ -S "$socket" ] && break
+        sleep 0.1
+    done
+    timeout 20 "$paracl" --connect "$socket" "$program" </dev/null >"$dir/out" 2>"$dir/err"
+    status=$?
+    if [ $status -eq 0 ] || ! grep -q "$error" "$dir/err"; then
+        echo "expected '$error', got status $status:"
+        cat "$dir/err"
+        exit 1
+    fi
+}
+
+expect time "--time-limit 1" "$dir/long.cl" "time limit exceeded"
+expect memory "--memory-limit 1" "$dir/wide.cl" "memory limit exceeded"
@@ -0,0 +1,12 @@
+// The outer loop gets hot and is compiled with the inner one inside it;
+// the inner loop never ends, so only the time limit stops the run.
+i = 0;
+j = 0;
+while (1) {
+    i = i + 1;
+    if (i > 2000) {
+        while (1) {
+            j = j + 1;
+        }
+    }
+}
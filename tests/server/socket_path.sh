@@ -0,0 +1,20 @@
+#!/bin/sh
+# Usage: socket_path.sh <paracl>
+# Expects `paracl --serve` to refuse a path that holds a regular file and
+# leave the file alone.
+paracl=$1
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+echo notes >"$dir/notes.txt"
+timeout 10 "$paracl" --serve "$dir/notes.txt" 2>"$dir/err"
+status=$?
+if [ $status -eq 0 ] || [ $status -eq 124 ] || ! grep -q "not a socket" "$dir/err"; then
+    echo "expected 'not a socket', got status $status:"
+    cat "$dir/err"
+    exit 1
+fi
+if [ "$(cat "$dir/notes.txt")" != notes ]; then
+    echo "the file was removed or changed"
+    exit 1
+fi
@@ -0,0 +1,29 @@
+#!/bin/sh
+# Usage: time_limit.sh <paracl> <program.cl>
+# Runs the program on a `paracl --serve` with a 500 ms time limit and
+# expects the server to stop it.
+paracl=$1
+program=$2
+dir=$(mktemp -d)
+socket=$dir/paracl.sock
+
+"$paracl" --serve "$socket" --jobs 1 --time-limit 500 &
+server=$!
+trap 'kill $server 2>/dev/null; rm -rf "$dir"' EXIT
+
+for _ in $(seq 50); do
+    [ -S "$socket" ] && break
+    sleep 0.1
+done
+
+timeout 10 "$paracl" --connect "$socket" "$program" </dev/null >"$dir/out" 2>"$dir/err"
+status=$?
+if [ $status -eq 124 ]; then
+    echo "the server did not stop the run"
+    exit 1
+fi
+if [ $status -eq 0 ] || ! grep -q "time limit exceeded" "$dir/err"; then
+    echo "expected 'time limit exceeded', got status $status:"
+    cat "$dir/err"
+    exit 1
+fi
@@ -0,0 +1,20 @@
+#!/bin/sh
+# Usage: stdin_input.sh <paracl>
+# Streams a program that uses `?` from stdin and expects it to be
+# rejected after the statements before it have run.
+paracl=$1
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+printf 'print 1;\nx = ?;\nprint x;\n' | "$paracl" --stream - >"$dir/out" 2>"$dir/err"
+status=$?
+if [ $status -eq 0 ] || ! grep -q "'?' can not read input" "$dir/err"; then
+    echo "expected the '?' to be rejected, got status $status:"
+    cat "$dir/err"
+    exit 1
+fi
+if [ "$(cat "$dir/out")" != 1 ]; then
+    echo "expected output 1, got:"
+    cat "$dir/out"
+    exit 1
+fi